@@ -39,6 +39,7 @@
 #include <linux/percpu.h>
 #include <linux/slab.h>
 #include <linux/syscore_ops.h>
+#include <linux/wakelock.h>
 
 #include <asm/irq.h>
 #include <asm/exception.h>
@@ -274,6 +275,7 @@ static void gic_show_resume_irq(struct gic_chip_data *gic)
 		if (TLMM_MSM_SUMMARY_IRQ != i + gic->irq_offset) {
 #endif
 			pr_warning("[K][WAKEUP] Resume caused by gic-%d\n",i + gic->irq_offset);
+			wakelock_set_resume_irq(i + gic->irq_offset);
 #if defined(CONFIG_ARCH_MSM8960) || defined(CONFIG_ARCH_APQ8064)
 		}
 #endif
@@ -0,0 +1,200 @@
+/*
+ * linux/arch/arm/crypto/ghash-neon-glue.c - GHASH using NEON vmull.p8
+ *
+ * Based on crypto/ghash-generic.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <asm/neon.h>
+#include <asm/unaligned.h>
+#include <crypto/algapi.h>
+#include <crypto/gf128mul.h>
+#include <crypto/internal/hash.h>
+#include <linux/crypto.h>
+#include <linux/hardirq.h>
+#include <linux/module.h>
+
+#define GHASH_BLOCK_SIZE	16
+#define GHASH_DIGEST_SIZE	16
+
+/*
+ * The hash key and the running digest are kept byte-reversed, as two
+ * 64-bit halves with the low half first, which is the layout the NEON
+ * code multiplies in.  The 4k table is only used when NEON cannot be
+ * used because we are called from interrupt context.
+ */
+struct ghash_ctx {
+	u64 key[2];
+	struct gf128mul_4k *gf128;
+};
+
+struct ghash_desc_ctx {
+	u64 digest[2];
+	u8 buf[GHASH_BLOCK_SIZE];
+	u32 count;
+};
+
+asmlinkage void ghash_neon_update(unsigned int blocks, u64 dg[],
+				  const u8 *src, const u64 key[]);
+
+static void ghash_do_update(struct ghash_ctx *ctx, u64 dg[], const u8 *src,
+			    unsigned int blocks)
+{
+	be128 x;
+
+	if (!in_interrupt()) {
+		kernel_neon_begin();
+		ghash_neon_update(blocks, dg, src, ctx->key);
+		kernel_neon_end();
+		return;
+	}
+
+	x.a = cpu_to_be64(dg[1]);
+	x.b = cpu_to_be64(dg[0]);
+	while (blocks--) {
+		crypto_xor((u8 *)&x, src, GHASH_BLOCK_SIZE);
+		gf128mul_4k_lle(&x, ctx->gf128);
+		src += GHASH_BLOCK_SIZE;
+	}
+	dg[1] = be64_to_cpu(x.a);
+	dg[0] = be64_to_cpu(x.b);
+}
+
+static int ghash_init(struct shash_desc *desc)
+{
+	struct ghash_desc_ctx *dctx = shash_desc_ctx(desc);
+
+	memset(dctx, 0, sizeof(*dctx));
+
+	return 0;
+}
+
+static int ghash_setkey(struct crypto_shash *tfm,
+			const u8 *key, unsigned int keylen)
+{
+	struct ghash_ctx *ctx = crypto_shash_ctx(tfm);
+
+	if (keylen != GHASH_BLOCK_SIZE) {
+		crypto_shash_set_flags(tfm, CRYPTO_TFM_RES_BAD_KEY_LEN);
+		return -EINVAL;
+	}
+
+	if (ctx->gf128)
+		gf128mul_free_4k(ctx->gf128);
+	ctx->gf128 = gf128mul_init_4k_lle((be128 *)key);
+	if (!ctx->gf128)
+		return -ENOMEM;
+
+	ctx->key[1] = get_unaligned_be64(key);
+	ctx->key[0] = get_unaligned_be64(key + 8);
+
+	return 0;
+}
+
+static int ghash_update(struct shash_desc *desc,
+			const u8 *src, unsigned int srclen)
+{
+	struct ghash_desc_ctx *dctx = shash_desc_ctx(desc);
+	struct ghash_ctx *ctx = crypto_shash_ctx(desc->tfm);
+	unsigned int partial = dctx->count % GHASH_BLOCK_SIZE;
+
+	if (!ctx->gf128)
+		return -ENOKEY;
+
+	dctx->count += srclen;
+
+	if (partial + srclen >= GHASH_BLOCK_SIZE) {
+		unsigned int blocks;
+
+		if (partial) {
+			int p = GHASH_BLOCK_SIZE - partial;
+
+			memcpy(dctx->buf + partial, src, p);
+			src += p;
+			srclen -= p;
+			ghash_do_update(ctx, dctx->digest, dctx->buf, 1);
+			partial = 0;
+		}
+
+		blocks = srclen / GHASH_BLOCK_SIZE;
+		if (blocks) {
+			ghash_do_update(ctx, dctx->digest, src, blocks);
+			src += blocks * GHASH_BLOCK_SIZE;
+			srclen %= GHASH_BLOCK_SIZE;
+		}
+	}
+	if (srclen)
+		memcpy(dctx->buf + partial, src, srclen);
+
+	return 0;
+}
+
+static int ghash_final(struct shash_desc *desc, u8 *dst)
+{
+	struct ghash_desc_ctx *dctx = shash_desc_ctx(desc);
+	struct ghash_ctx *ctx = crypto_shash_ctx(desc->tfm);
+	unsigned int partial = dctx->count % GHASH_BLOCK_SIZE;
+
+	if (!ctx->gf128)
+		return -ENOKEY;
+
+	if (partial) {
+		memset(dctx->buf + partial, 0, GHASH_BLOCK_SIZE - partial);
+		ghash_do_update(ctx, dctx->digest, dctx->buf, 1);
+	}
+	put_unaligned_be64(dctx->digest[1], dst);
+	put_unaligned_be64(dctx->digest[0], dst + 8);
+
+	memset(dctx, 0, sizeof(*dctx));
+
+	return 0;
+}
+
+static void ghash_exit_tfm(struct crypto_tfm *tfm)
+{
+	struct ghash_ctx *ctx = crypto_tfm_ctx(tfm);
+	if (ctx->gf128)
+		gf128mul_free_4k(ctx->gf128);
+}
+
+static struct shash_alg ghash_alg = {
+	.digestsize	= GHASH_DIGEST_SIZE,
+	.init		= ghash_init,
+	.update		= ghash_update,
+	.final		= ghash_final,
+	.setkey		= ghash_setkey,
+	.descsize	= sizeof(struct ghash_desc_ctx),
+	.base		= {
+		.cra_name		= "ghash",
+		.cra_driver_name	= "ghash-neon",
+		.cra_priority		= 150,
+		.cra_flags		= CRYPTO_ALG_TYPE_SHASH,
+		.cra_blocksize		= GHASH_BLOCK_SIZE,
+		.cra_ctxsize		= sizeof(struct ghash_ctx),
+		.cra_module		= THIS_MODULE,
+		.cra_exit		= ghash_exit_tfm,
+	},
+};
+
+static int __init ghash_neon_mod_init(void)
+{
+	if (!cpu_has_neon())
+		return -ENODEV;
+
+	return crypto_register_shash(&ghash_alg);
+}
+
+static void __exit ghash_neon_mod_exit(void)
+{
+	crypto_unregister_shash(&ghash_alg);
+}
+
+module_init(ghash_neon_mod_init);
+module_exit(ghash_neon_mod_exit);
+
+MODULE_DESCRIPTION("GHASH Message Digest Algorithm using NEON");
+MODULE_LICENSE("GPL");
+MODULE_ALIAS("ghash");
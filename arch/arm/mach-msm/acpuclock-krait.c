@@ -21,6 +21,8 @@
 #include <linux/errno.h>
 #include <linux/cpufreq.h>
 #include <linux/cpu.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
 #include <linux/regulator/consumer.h>
 
 #include <asm/mach-types.h>
@@ -37,6 +39,7 @@
 #include "acpuclock.h"
 #include "acpuclock-krait.h"
 #include "avs.h"
+#include "pm.h"
 
 #define CPU_FOOT_PRINT_MAGIC				0xACBDFE00
 static void set_acpuclk_foot_print(unsigned cpu, unsigned state)
@@ -1019,6 +1022,65 @@ static void __init cpufreq_table_init(void)
 static void __init cpufreq_table_init(void) {}
 #endif
 
+#ifdef CONFIG_SMP
+static struct sched_energy_model krait_energy_model = {
+	.cur_freq = acpuclk_krait_get_rate,
+};
+
+static unsigned long __init krait_busy_power(const struct acpu_level *l)
+{
+	u64 mv = calculate_vdd_core(l) / 1000;
+
+	/* C * V^2 * f in mW, with an effective switched capacitance of 0.6nF */
+	return div_u64((l->speed.khz / 1000) * mv * mv * 6, 10000000);
+}
+
+static unsigned long __init krait_idle_exit_us(void)
+{
+#ifdef CONFIG_MSM_PM8X60
+	return msm_pm_sleep_modes[MSM_PM_MODE(0,
+			MSM_PM_SLEEP_MODE_POWER_COLLAPSE_STANDALONE)].residency;
+#else
+	return 0;
+#endif
+}
+
+static void __init energy_model_init(void)
+{
+	struct sched_power_state *states;
+	const struct acpu_level *l;
+	int n = 0;
+
+	for (l = drv.acpu_freq_tbl; l->speed.khz != 0; l++)
+		if (l->use_for_scaling)
+			n++;
+
+	states = kcalloc(n, sizeof(*states), GFP_KERNEL);
+	if (!n || !states) {
+		kfree(states);
+		return;
+	}
+
+	n = 0;
+	for (l = drv.acpu_freq_tbl; l->speed.khz != 0; l++) {
+		if (!l->use_for_scaling)
+			continue;
+		states[n].freq = l->speed.khz;
+		states[n].power = krait_busy_power(l);
+		n++;
+	}
+
+	krait_energy_model.states = states;
+	krait_energy_model.nr_states = n;
+	krait_energy_model.idle_exit_cost =
+		krait_idle_exit_us() * states[0].power;
+
+	sched_set_energy_model(&krait_energy_model);
+}
+#else
+static void __init energy_model_init(void) {}
+#endif
+
 static int __cpuinit acpuclk_cpu_callback(struct notifier_block *nfb,
 					    unsigned long action, void *hcpu)
 {
@@ -1275,6 +1337,7 @@ int __init acpuclk_krait_init(struct device *dev,
 	hw_init();
 
 	cpufreq_table_init();
+	energy_model_init();
 	acpuclk_register(&acpuclk_krait_data);
 	register_hotcpu_notifier(&acpuclk_cpu_notifier);
 
@@ -430,7 +430,7 @@ static void queue_rx(void)
 
 		INIT_WORK(&info->work, handle_bam_mux_cmd);
 
-		info->skb = __dev_alloc_skb(BUFFER_SIZE,
+		info->skb = __netdev_alloc_skb(NULL, BUFFER_SIZE,
 						GFP_NOWAIT | __GFP_NOWARN);
 		if (info->skb == NULL) {
 			DMUX_LOG_KERR(
@@ -1055,6 +1055,17 @@ int msm_bam_dmux_is_ch_low(uint32_t id)
 	return ret;
 }
 
+int msm_bam_dmux_is_polling(void)
+{
+	return polling_mode;
+}
+
+static void rx_batch_done(void)
+{
+	local_bh_disable();
+	local_bh_enable();
+}
+
 static void rx_switch_to_interrupt_mode(void)
 {
 	struct sps_connect cur_rx_conn;
@@ -1124,6 +1135,7 @@ static void rx_switch_to_interrupt_mode(void)
 		mutex_unlock(&bam_rx_pool_mutexlock);
 		handle_bam_mux_cmd(&info->work);
 	}
+	rx_batch_done();
 	DBG("%s: exit\n", __func__);
 	return;
 
@@ -1187,6 +1199,9 @@ static void rx_timer_work_func(struct work_struct *work)
 			handle_bam_mux_cmd(&info->work);
 		}
 
+		if (!inactive_cycles)
+			rx_batch_done();
+
 		if (inactive_cycles >= POLLING_INACTIVITY) {
 			rx_switch_to_interrupt_mode();
 			break;
@@ -57,6 +57,8 @@ int msm_bam_dmux_is_ch_full(uint32_t id);
 
 int msm_bam_dmux_is_ch_low(uint32_t id);
 
+int msm_bam_dmux_is_polling(void);
+
 int msm_bam_dmux_reg_notify(void *priv,
 		       void (*notify)(void *priv, int event_type,
 						unsigned long data));
@@ -103,6 +105,11 @@ static inline int msm_bam_dmux_is_ch_low(uint32_t id)
 	return -ENODEV;
 }
 
+static inline int msm_bam_dmux_is_polling(void)
+{
+	return 0;
+}
+
 static inline int msm_bam_dmux_reg_notify(void *priv,
 		       void (*notify)(void *priv, int event_type,
 						unsigned long data))
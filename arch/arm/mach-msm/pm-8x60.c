@@ -815,6 +815,121 @@ void arch_idle(void)
 	return;
 }
 
+#define MSM_PM_PREDICT_BUCKETS		6
+#define MSM_PM_PREDICT_INTERVALS	8
+#define MSM_PM_PREDICT_RESOLUTION	1024
+#define MSM_PM_PREDICT_DECAY		8
+#define MSM_PM_PREDICT_UNIT		\
+	(MSM_PM_PREDICT_RESOLUTION * MSM_PM_PREDICT_DECAY)
+#define MSM_PM_PREDICT_MAX_US		50000
+
+struct msm_pm_idle_predictor {
+	uint32_t next_timer_us;
+	int bucket;
+	unsigned int correction_factor[MSM_PM_PREDICT_BUCKETS];
+	uint32_t intervals[MSM_PM_PREDICT_INTERVALS];
+	int interval_ptr;
+};
+
+static DEFINE_PER_CPU(struct msm_pm_idle_predictor, msm_pm_idle_predictors);
+static DEFINE_PER_CPU(uint32_t, msm_pm_idle_sleep_us);
+
+static int msm_pm_idle_predict = 1;
+module_param_named(
+	idle_predict, msm_pm_idle_predict, int, S_IRUGO | S_IWUSR | S_IWGRP
+);
+
+static int msm_pm_predict_bucket(uint32_t sleep_us)
+{
+	int bucket = 0;
+
+	while (bucket < MSM_PM_PREDICT_BUCKETS - 1 && sleep_us >= 10) {
+		sleep_us /= 10;
+		bucket++;
+	}
+	return bucket;
+}
+
+static uint32_t msm_pm_predict_typical(struct msm_pm_idle_predictor *p)
+{
+	uint64_t avg = 0;
+	uint64_t variance = 0;
+	unsigned long stddev;
+	int i;
+
+	for (i = 0; i < MSM_PM_PREDICT_INTERVALS; i++) {
+		if (!p->intervals[i])
+			return UINT_MAX;
+		avg += p->intervals[i];
+	}
+	avg = div_u64(avg, MSM_PM_PREDICT_INTERVALS);
+
+	for (i = 0; i < MSM_PM_PREDICT_INTERVALS; i++) {
+		int64_t diff = (int64_t)p->intervals[i] - (int64_t)avg;
+		variance += diff * diff;
+	}
+	variance = div_u64(variance, MSM_PM_PREDICT_INTERVALS);
+	stddev = int_sqrt((unsigned long)variance);
+
+	if (stddev <= 20 || avg > 6 * (uint64_t)stddev)
+		return (uint32_t)avg;
+
+	return UINT_MAX;
+}
+
+static uint32_t msm_pm_predict_sleep(unsigned int cpu, uint32_t sleep_us)
+{
+	struct msm_pm_idle_predictor *p = &per_cpu(msm_pm_idle_predictors, cpu);
+	uint64_t predicted;
+	uint32_t typical;
+
+	p->next_timer_us = sleep_us;
+	p->bucket = msm_pm_predict_bucket(sleep_us);
+
+	if (!p->correction_factor[p->bucket])
+		p->correction_factor[p->bucket] = MSM_PM_PREDICT_UNIT;
+
+	predicted = (uint64_t)sleep_us * p->correction_factor[p->bucket];
+	predicted = div_u64(predicted + MSM_PM_PREDICT_UNIT / 2,
+			MSM_PM_PREDICT_UNIT);
+
+	typical = msm_pm_predict_typical(p);
+	if (typical < predicted)
+		predicted = typical;
+
+	return (uint32_t)min_t(uint64_t, predicted, sleep_us);
+}
+
+static void msm_pm_predict_update(unsigned int cpu, uint32_t measured_us)
+{
+	struct msm_pm_idle_predictor *p = &per_cpu(msm_pm_idle_predictors, cpu);
+	unsigned int factor;
+
+	if (!p->next_timer_us)
+		return;
+
+	if (measured_us > p->next_timer_us)
+		measured_us = p->next_timer_us;
+
+	factor = p->correction_factor[p->bucket];
+	factor -= factor / MSM_PM_PREDICT_DECAY;
+
+	if (p->next_timer_us < MSM_PM_PREDICT_MAX_US)
+		factor += div_u64((uint64_t)MSM_PM_PREDICT_RESOLUTION *
+				measured_us, p->next_timer_us);
+	else
+		factor += MSM_PM_PREDICT_RESOLUTION;
+
+	p->correction_factor[p->bucket] = factor ? factor : 1;
+
+	p->intervals[p->interval_ptr++] =
+		min_t(uint32_t, measured_us, MSM_PM_PREDICT_MAX_US) ? : 1;
+	if (p->interval_ptr >= MSM_PM_PREDICT_INTERVALS)
+		p->interval_ptr = 0;
+
+	p->next_timer_us = 0;
+}
+
 int msm_pm_idle_prepare(struct cpuidle_device *dev,
 		struct cpuidle_driver *drv, int index)
 {
@@ -827,6 +942,9 @@ int msm_pm_idle_prepare(struct cpuidle_device *dev,
 	latency_us = (uint32_t) pm_qos_request(PM_QOS_CPU_DMA_LATENCY);
 	sleep_us = (uint32_t) ktime_to_ns(tick_nohz_get_sleep_length());
 	sleep_us = DIV_ROUND_UP(sleep_us, 1000);
+	if (msm_pm_idle_predict)
+		sleep_us = msm_pm_predict_sleep(dev->cpu, sleep_us);
+	per_cpu(msm_pm_idle_sleep_us, dev->cpu) = sleep_us;
 
 	for (i = 0; i < dev->state_count; i++) {
 		struct cpuidle_state *state = &drv->states[i];
@@ -849,7 +967,14 @@ int msm_pm_idle_prepare(struct cpuidle_device *dev,
 			if (!allow)
 				break;
 
-			if (num_online_cpus() > 1 || cpu_maps_is_updating()) {
+			if (cpu_maps_is_updating()) {
+				allow = false;
+				break;
+			}
+
+			if (num_online_cpus() > 1 &&
+				(mode != MSM_PM_SLEEP_MODE_POWER_COLLAPSE ||
+				 !pm_sleep_ops.cpu_idle_notify)) {
 				allow = false;
 				break;
 			}
@@ -989,12 +1114,19 @@ int msm_pm_idle_enter(enum msm_pm_sleep_mode sleep_mode)
 {
 	int64_t time;
 	int exit_stat;
+	unsigned int cpu;
 	uint64_t xo_shutdown_time, vdd_min_time;
 
 	if (MSM_PM_DEBUG_IDLE & msm_pm_debug_mask)
 		pr_info("CPU%u: %s: mode %d\n",
 			smp_processor_id(), __func__, sleep_mode);
 
+	cpu = smp_processor_id();
+	if (pm_sleep_ops.cpu_idle_notify &&
+			sleep_mode != MSM_PM_SLEEP_MODE_NOT_SELECTED)
+		pm_sleep_ops.cpu_idle_notify(cpu, sleep_mode,
+				per_cpu(msm_pm_idle_sleep_us, cpu));
+
 	time = ktime_to_ns(ktime_get());
 
 	switch (sleep_mode) {
@@ -1072,6 +1204,14 @@ int msm_pm_idle_enter(enum msm_pm_sleep_mode sleep_mode)
 	time = ktime_to_ns(ktime_get()) - time;
 	msm_pm_add_stat(exit_stat, time);
 	do_div(time, 1000);
+
+	if (pm_sleep_ops.cpu_idle_notify)
+		pm_sleep_ops.cpu_idle_notify(cpu,
+				MSM_PM_SLEEP_MODE_NOT_SELECTED, 0);
+
+	msm_pm_predict_update(cpu, (uint32_t)time);
+	if (time < msm_pm_sleep_modes[MSM_PM_MODE(cpu, sleep_mode)].residency)
+		msm_pm_add_short_stat(exit_stat);
 	if ((get_kernel_flag() & KERNEL_FLAG_PM_MONITOR) ||
 		(!(get_kernel_flag() & KERNEL_FLAG_TEST_PWR_SUPPLY) && (!get_tamper_sf())))
 		htc_idle_stat_add(sleep_mode, (u32)time);
@@ -1079,6 +1219,9 @@ int msm_pm_idle_enter(enum msm_pm_sleep_mode sleep_mode)
 	return (int) time;
 
 cpuidle_enter_bail:
+	if (pm_sleep_ops.cpu_idle_notify)
+		pm_sleep_ops.cpu_idle_notify(cpu,
+				MSM_PM_SLEEP_MODE_NOT_SELECTED, 0);
 	return 0;
 }
 
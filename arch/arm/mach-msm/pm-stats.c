@@ -27,6 +27,7 @@ struct msm_pm_time_stats {
 	int64_t min_time[CONFIG_MSM_IDLE_STATS_BUCKET_COUNT];
 	int64_t max_time[CONFIG_MSM_IDLE_STATS_BUCKET_COUNT];
 	int count;
+	int too_short;
 	int64_t total_time;
 	bool enabled;
 };
@@ -79,6 +80,20 @@ add_bail:
 	spin_unlock_irqrestore(&msm_pm_stats_lock, flags);
 }
 
+void msm_pm_add_short_stat(enum msm_pm_time_stats_id id)
+{
+	unsigned long flags;
+	struct msm_pm_time_stats *stats;
+
+	spin_lock_irqsave(&msm_pm_stats_lock, flags);
+	stats = __get_cpu_var(msm_pm_stats).stats;
+
+	if (stats[id].enabled)
+		stats[id].too_short++;
+
+	spin_unlock_irqrestore(&msm_pm_stats_lock, flags);
+}
+
 #define SNPRINTF(buf, size, format, ...) \
 	do { \
 		if (size > 0) { \
@@ -130,9 +145,11 @@ static int msm_pm_read_proc
 		SNPRINTF(p, count,
 			"[cpu %u] %s:\n"
 			"  count: %7d\n"
+			"  too_short: %7d\n"
 			"  total_time: %lld.%09u\n",
 			cpu, stats[id].name,
 			stats[id].count,
+			stats[id].too_short,
 			s, ns);
 
 		bucket_time = stats[id].first_bucket_time;
@@ -204,6 +221,7 @@ static int msm_pm_write_proc(struct file *file, const char __user *buffer,
 			memset(stats[i].max_time,
 				0, sizeof(stats[i].max_time));
 			stats[i].count = 0;
+			stats[i].too_short = 0;
 			stats[i].total_time = 0;
 		}
 	}
@@ -83,6 +83,8 @@ struct msm_pm_sleep_ops {
 			bool from_idle, bool notify_rpm);
 	void (*exit_sleep)(void *limits, bool from_idle,
 			bool notify_rpm, bool collapsed);
+	void (*cpu_idle_notify)(unsigned int cpu,
+			enum msm_pm_sleep_mode sleep_mode, uint32_t sleep_us);
 };
 
 void msm_pm_set_platform_data(struct msm_pm_platform_data *data, int count);
@@ -137,10 +139,12 @@ enum msm_pm_time_stats_id {
 #ifdef CONFIG_MSM_IDLE_STATS
 void msm_pm_add_stats(enum msm_pm_time_stats_id *enable_stats, int size);
 void msm_pm_add_stat(enum msm_pm_time_stats_id id, int64_t t);
+void msm_pm_add_short_stat(enum msm_pm_time_stats_id id);
 #else
 static inline void msm_pm_add_stats(enum msm_pm_time_stats_id *enable_stats,
 		int size) {}
 static inline void msm_pm_add_stat(enum msm_pm_time_stats_id id, int64_t t) {}
+static inline void msm_pm_add_short_stat(enum msm_pm_time_stats_id id) {}
 #endif
 
 int print_gpio_buffer(struct seq_file *m);
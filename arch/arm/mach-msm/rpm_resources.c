@@ -20,6 +20,7 @@
 #include <linux/proc_fs.h>
 #include <linux/spinlock.h>
 #include <linux/cpu.h>
+#include <linux/ktime.h>
 #include <mach/rpm.h>
 #include <mach/msm_iomap.h>
 #include <asm/mach-types.h>
@@ -44,6 +45,19 @@ module_param_named(
 static struct msm_rpmrs_level *msm_rpmrs_levels;
 static int msm_rpmrs_level_count;
 
+struct msm_rpmrs_cpu_idle {
+	enum msm_pm_sleep_mode mode;
+	int64_t wakeup_ns;
+	unsigned int cluster_entries;
+	unsigned int cluster_aborts;
+};
+
+static DEFINE_PER_CPU(struct msm_rpmrs_cpu_idle, msm_rpmrs_idle_state) = {
+	.mode = MSM_PM_SLEEP_MODE_NOT_SELECTED,
+};
+static DEFINE_SPINLOCK(msm_rpmrs_cluster_lock);
+static bool msm_rpmrs_cluster_idle;
+
 static bool msm_rpmrs_pxo_beyond_limits(struct msm_rpmrs_limits *limits);
 static void msm_rpmrs_aggregate_pxo(struct msm_rpmrs_limits *limits);
 static void msm_rpmrs_restore_pxo(void);
@@ -169,6 +183,12 @@ static struct attribute_group msm_rpmrs_mode_attribute_group = {
 #define GET_RS_FROM_ATTR(attr) \
 	(container_of(attr, struct msm_rpmrs_resource, ko_attr))
 
+static ssize_t msm_rpmrs_cluster_stats_show(
+	struct kobject *kobj, struct kobj_attribute *attr, char *buf);
+
+static struct kobj_attribute msm_rpmrs_cluster_stats_attr =
+	__ATTR(cluster_stats, S_IRUGO, msm_rpmrs_cluster_stats_show, NULL);
+
 
 
 static void msm_rpmrs_aggregate_sclk(uint32_t sclk_count)
@@ -690,6 +710,24 @@ static ssize_t msm_rpmrs_resource_attr_store(struct kobject *kobj,
 	return count;
 }
 
+static ssize_t msm_rpmrs_cluster_stats_show(
+	struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	unsigned int cpu;
+	ssize_t len = 0;
+
+	for_each_possible_cpu(cpu) {
+		struct msm_rpmrs_cpu_idle *ci =
+			&per_cpu(msm_rpmrs_idle_state, cpu);
+
+		len += scnprintf(buf + len, PAGE_SIZE - len,
+			"cpu%u: entries %u aborts %u\n", cpu,
+			ci->cluster_entries, ci->cluster_aborts);
+	}
+
+	return len;
+}
+
 static int __init msm_rpmrs_resource_sysfs_add(void)
 {
 	struct kobject *module_kobj = NULL;
@@ -733,6 +771,12 @@ static int __init msm_rpmrs_resource_sysfs_add(void)
 		goto resource_sysfs_add_exit;
 	}
 
+	rc = sysfs_create_file(module_kobj, &msm_rpmrs_cluster_stats_attr.attr);
+	if (rc) {
+		pr_err("%s: cannot create cluster_stats attribute\n", __func__);
+		goto resource_sysfs_add_exit;
+	}
+
 	rc = 0;
 resource_sysfs_add_exit:
 	if (rc) {
@@ -856,6 +900,78 @@ s32 msm_cpuidle_get_deep_idle_latency(void)
 	return best->latency_us - 1;
 }
 
+static void msm_rpmrs_cpu_idle_notify(unsigned int cpu,
+		enum msm_pm_sleep_mode mode, uint32_t sleep_us)
+{
+	struct msm_rpmrs_cpu_idle *ci = &per_cpu(msm_rpmrs_idle_state, cpu);
+	unsigned long flags;
+	int64_t wakeup_ns = 0;
+
+	if (!msm_rpmrs_cluster_idle)
+		return;
+
+	if (mode != MSM_PM_SLEEP_MODE_NOT_SELECTED)
+		wakeup_ns = ktime_to_ns(ktime_get()) +
+				(int64_t)sleep_us * NSEC_PER_USEC;
+
+	spin_lock_irqsave(&msm_rpmrs_cluster_lock, flags);
+	ci->mode = mode;
+	ci->wakeup_ns = wakeup_ns;
+	spin_unlock_irqrestore(&msm_rpmrs_cluster_lock, flags);
+}
+
+static void msm_rpmrs_cluster_idle_reset(void)
+{
+	unsigned long flags;
+	unsigned int cpu;
+
+	spin_lock_irqsave(&msm_rpmrs_cluster_lock, flags);
+	for_each_possible_cpu(cpu) {
+		struct msm_rpmrs_cpu_idle *ci =
+			&per_cpu(msm_rpmrs_idle_state, cpu);
+
+		ci->mode = MSM_PM_SLEEP_MODE_NOT_SELECTED;
+		ci->wakeup_ns = 0;
+	}
+	spin_unlock_irqrestore(&msm_rpmrs_cluster_lock, flags);
+}
+
+static uint32_t msm_rpmrs_cluster_sleep_us(unsigned int cpu,
+		uint32_t sleep_us)
+{
+	int64_t now = ktime_to_ns(ktime_get());
+	unsigned long flags;
+	unsigned int i;
+
+	spin_lock_irqsave(&msm_rpmrs_cluster_lock, flags);
+	for_each_online_cpu(i) {
+		struct msm_rpmrs_cpu_idle *ci =
+			&per_cpu(msm_rpmrs_idle_state, i);
+		int64_t left;
+
+		if (i == cpu)
+			continue;
+
+		if (ci->mode != MSM_PM_SLEEP_MODE_POWER_COLLAPSE_STANDALONE) {
+			sleep_us = 0;
+			break;
+		}
+
+		left = ci->wakeup_ns - now;
+		if (left <= 0) {
+			sleep_us = 0;
+			break;
+		}
+
+		left = div_s64(left, NSEC_PER_USEC);
+		if (left < sleep_us)
+			sleep_us = (uint32_t)left;
+	}
+	spin_unlock_irqrestore(&msm_rpmrs_cluster_lock, flags);
+
+	return sleep_us;
+}
+
 static void *msm_rpmrs_lowest_limits(bool from_idle,
 		enum msm_pm_sleep_mode sleep_mode, uint32_t latency_us,
 		uint32_t sleep_us, uint32_t *power)
@@ -864,10 +980,17 @@ static void *msm_rpmrs_lowest_limits(bool from_idle,
 	struct msm_rpmrs_level *best_level = NULL;
 	bool irqs_detectable = false;
 	bool gpio_detectable = false;
+	bool cluster_abort = false;
+	uint32_t cluster_us = sleep_us;
 	int i;
 	uint32_t pwr;
 
 	if (sleep_mode == MSM_PM_SLEEP_MODE_POWER_COLLAPSE) {
+		if (from_idle && num_online_cpus() > 1) {
+			if (!msm_rpmrs_cluster_idle)
+				return NULL;
+			cluster_us = msm_rpmrs_cluster_sleep_us(cpu, sleep_us);
+		}
 		irqs_detectable = msm_mpm_irqs_detectable(from_idle);
 		gpio_detectable = msm_mpm_gpio_irqs_detectable(from_idle);
 	}
@@ -887,6 +1010,11 @@ static void *msm_rpmrs_lowest_limits(bool from_idle,
 		if (sleep_us <= level->time_overhead_us)
 			continue;
 
+		if (cluster_us <= level->time_overhead_us) {
+			cluster_abort = true;
+			continue;
+		}
+
 		if (!msm_rpmrs_irqs_detectable(&level->rs_limits,
 					irqs_detectable, gpio_detectable))
 			continue;
@@ -897,17 +1025,17 @@ static void *msm_rpmrs_lowest_limits(bool from_idle,
 					break;
 
 
-		if (sleep_us <= 1) {
+		if (cluster_us <= 1) {
 			pwr = level->energy_overhead;
-		} else if (sleep_us <= level->time_overhead_us) {
-			pwr = level->energy_overhead / sleep_us;
-		} else if ((sleep_us >> 10) > level->time_overhead_us) {
+		} else if (cluster_us <= level->time_overhead_us) {
+			pwr = level->energy_overhead / cluster_us;
+		} else if ((cluster_us >> 10) > level->time_overhead_us) {
 			pwr = level->steady_state_power;
 		} else {
 			pwr = level->steady_state_power;
 			pwr -= (level->time_overhead_us *
-					level->steady_state_power)/sleep_us;
-			pwr += level->energy_overhead / sleep_us;
+					level->steady_state_power)/cluster_us;
+			pwr += level->energy_overhead / cluster_us;
 		}
 
 		if (!best_level ||
@@ -920,14 +1048,25 @@ static void *msm_rpmrs_lowest_limits(bool from_idle,
 		}
 	}
 
+	if (from_idle && cluster_abort)
+		per_cpu(msm_rpmrs_idle_state, cpu).cluster_aborts++;
+
 	return best_level ? &best_level->rs_limits : NULL;
 }
 
 static int msm_rpmrs_enter_sleep(uint32_t sclk_count, void *limits,
 		bool from_idle, bool notify_rpm)
 {
+	struct msm_rpmrs_cpu_idle *ci = &__get_cpu_var(msm_rpmrs_idle_state);
+	bool cluster = from_idle && notify_rpm && num_online_cpus() > 1;
 	int rc = 0;
 
+	if (cluster && (!msm_rpmrs_cluster_idle ||
+	    !msm_rpmrs_cluster_sleep_us(smp_processor_id(), UINT_MAX))) {
+		ci->cluster_aborts++;
+		return -EBUSY;
+	}
+
 	if (notify_rpm) {
 		rc = msm_rpmrs_flush_buffer(sclk_count, limits, from_idle);
 		if (rc)
@@ -938,6 +1077,9 @@ static int msm_rpmrs_enter_sleep(uint32_t sclk_count, void *limits,
 	}
 
 	rc = msm_rpmrs_flush_L2(limits, notify_rpm);
+	if (!rc && cluster)
+		ci->cluster_entries++;
+
 	return rc;
 }
 
@@ -952,21 +1094,23 @@ static void msm_rpmrs_exit_sleep(void *limits, bool from_idle,
 		msm_mpm_exit_sleep(from_idle);
 }
 
+static void msm_rpmrs_update_l2_value(void)
+{
+	if (num_online_cpus() > 1 && !msm_rpmrs_cluster_idle)
+		msm_rpmrs_l2_cache.rs[0].value = MSM_RPMRS_L2_CACHE_ACTIVE;
+	else
+		msm_rpmrs_l2_cache.rs[0].value = MSM_RPMRS_L2_CACHE_HSFS_OPEN;
+}
+
 static int rpmrs_cpu_callback(struct notifier_block *nfb,
 		unsigned long action, void *hcpu)
 {
 	switch (action) {
 	case CPU_ONLINE_FROZEN:
 	case CPU_ONLINE:
-		if (num_online_cpus() > 1)
-			msm_rpmrs_l2_cache.rs[0].value =
-				MSM_RPMRS_L2_CACHE_ACTIVE;
-		break;
 	case CPU_DEAD_FROZEN:
 	case CPU_DEAD:
-		if (num_online_cpus() == 1)
-			msm_rpmrs_l2_cache.rs[0].value =
-				MSM_RPMRS_L2_CACHE_HSFS_OPEN;
+		msm_rpmrs_update_l2_value();
 		break;
 	}
 
@@ -974,6 +1118,36 @@ static int rpmrs_cpu_callback(struct notifier_block *nfb,
 	return NOTIFY_OK;
 }
 
+static int msm_rpmrs_cluster_idle_set(const char *val,
+		const struct kernel_param *kp)
+{
+	bool was_enabled = msm_rpmrs_cluster_idle;
+	unsigned long flags;
+	int rc;
+
+	rc = param_set_bool(val, kp);
+	if (rc)
+		return rc;
+
+	if (msm_rpmrs_cluster_idle && !was_enabled)
+		msm_rpmrs_cluster_idle_reset();
+
+	spin_lock_irqsave(&msm_rpmrs_lock, flags);
+	if (msm_rpmrs_l2_cache.beyond_limits == msm_spm_l2_cache_beyond_limits)
+		msm_rpmrs_update_l2_value();
+	msm_rpmrs_update_levels();
+	spin_unlock_irqrestore(&msm_rpmrs_lock, flags);
+
+	return 0;
+}
+
+static struct kernel_param_ops msm_rpmrs_cluster_idle_ops = {
+	.set = msm_rpmrs_cluster_idle_set,
+	.get = param_get_bool,
+};
+module_param_cb(cluster_idle, &msm_rpmrs_cluster_idle_ops,
+		&msm_rpmrs_cluster_idle, S_IRUGO | S_IWUSR | S_IWGRP);
+
 static struct notifier_block __refdata rpmrs_cpu_notifier = {
 	.notifier_call = rpmrs_cpu_callback,
 };
@@ -1076,6 +1250,7 @@ static struct msm_pm_sleep_ops msm_rpmrs_ops = {
 	.lowest_limits = msm_rpmrs_lowest_limits,
 	.enter_sleep = msm_rpmrs_enter_sleep,
 	.exit_sleep = msm_rpmrs_exit_sleep,
+	.cpu_idle_notify = msm_rpmrs_cpu_idle_notify,
 };
 
 static int __init msm_rpmrs_l2_init(void)
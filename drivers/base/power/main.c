@@ -29,6 +29,7 @@
 #include <linux/async.h>
 #include <linux/suspend.h>
 #include <linux/timer.h>
+#include <linux/slab.h>
 
 #include "../base.h"
 #include "power.h"
@@ -47,6 +48,7 @@ static DEFINE_MUTEX(dpm_list_mtx);
 static pm_message_t pm_transition;
 
 static void dpm_drv_timeout(unsigned long data);
+static void dpm_links_remove(struct device *dev);
 struct dpm_drv_wd_data {
 	struct device *dev;
 	struct task_struct *tsk;
@@ -64,6 +66,8 @@ void device_pm_init(struct device *dev)
 	spin_lock_init(&dev->power.lock);
 	pm_runtime_init(dev);
 	INIT_LIST_HEAD(&dev->power.entry);
+	INIT_LIST_HEAD(&dev->power.suppliers);
+	INIT_LIST_HEAD(&dev->power.consumers);
 	dev->power.power_state = PMSG_INVALID;
 }
 
@@ -99,6 +103,7 @@ void device_pm_remove(struct device *dev)
 	dev_pm_qos_constraints_destroy(dev);
 	list_del_init(&dev->power.entry);
 	mutex_unlock(&dpm_list_mtx);
+	dpm_links_remove(dev);
 	device_wakeup_disable(dev);
 	pm_runtime_remove(dev);
 }
@@ -128,31 +133,30 @@ void device_pm_move_last(struct device *dev)
 	list_move_tail(&dev->power.entry, &dpm_list);
 }
 
+#define PM_SLOW_CALLBACK_USECS	20000
+
 static ktime_t initcall_debug_start(struct device *dev)
 {
-	ktime_t calltime = ktime_set(0, 0);
-
-	if (initcall_debug) {
+	if (initcall_debug)
 		pr_info("calling  %s+ @ %i, parent: %s\n",
 			dev_name(dev), task_pid_nr(current),
 			dev->parent ? dev_name(dev->parent) : "none");
-		calltime = ktime_get();
-	}
 
-	return calltime;
+	return ktime_get();
 }
 
 static void initcall_debug_report(struct device *dev, ktime_t calltime,
 				  int error)
 {
-	ktime_t delta, rettime;
+	s64 usecs = ktime_us_delta(ktime_get(), calltime);
 
-	if (initcall_debug) {
-		rettime = ktime_get();
-		delta = ktime_sub(rettime, calltime);
+	if (initcall_debug)
 		pr_info("call %s+ returned %d after %Ld usecs\n", dev_name(dev),
-			error, (unsigned long long)ktime_to_ns(delta) >> 10);
-	}
+			error, usecs);
+	else if (usecs >= PM_SLOW_CALLBACK_USECS)
+		pr_info("PM: %s%s took %Ld usecs\n", dev_name(dev),
+			pm_async_enabled && dev->power.async_suspend ?
+			" (async)" : "", usecs);
 }
 
 static void dpm_wait(struct device *dev, bool async)
@@ -175,6 +179,153 @@ static void dpm_wait_for_children(struct device *dev, bool async)
        device_for_each_child(dev, &async, dpm_wait_fn);
 }
 
+/*
+ * Supplier links order a consumer after devices other than its parent:
+ * the consumer resumes after and suspends before each of its suppliers,
+ * both in the dpm_list order and when either side is async.
+ */
+struct dpm_link {
+	struct device		*supplier;
+	struct device		*consumer;
+	struct list_head	supplier_node;
+	struct list_head	consumer_node;
+};
+
+static DEFINE_MUTEX(dpm_link_mtx);
+
+static bool dpm_link_wait(struct device *dev, bool async)
+{
+	if (completion_done(&dev->power.completion) ||
+	    !(async || (pm_async_enabled && dev->power.async_suspend)))
+		return false;
+
+	get_device(dev);
+	mutex_unlock(&dpm_link_mtx);
+	wait_for_completion(&dev->power.completion);
+	put_device(dev);
+	return true;
+}
+
+static void dpm_wait_for_suppliers(struct device *dev, bool async)
+{
+	struct dpm_link *link;
+
+ again:
+	mutex_lock(&dpm_link_mtx);
+	list_for_each_entry(link, &dev->power.suppliers, supplier_node)
+		if (dpm_link_wait(link->supplier, async))
+			goto again;
+	mutex_unlock(&dpm_link_mtx);
+}
+
+static void dpm_wait_for_consumers(struct device *dev, bool async)
+{
+	struct dpm_link *link;
+
+ again:
+	mutex_lock(&dpm_link_mtx);
+	list_for_each_entry(link, &dev->power.consumers, consumer_node)
+		if (dpm_link_wait(link->consumer, async))
+			goto again;
+	mutex_unlock(&dpm_link_mtx);
+}
+
+static int dpm_is_dependent(struct device *dev, void *target)
+{
+	struct dpm_link *link;
+
+	if (dev == target)
+		return 1;
+
+	if (device_for_each_child(dev, target, dpm_is_dependent))
+		return 1;
+
+	list_for_each_entry(link, &dev->power.consumers, consumer_node)
+		if (dpm_is_dependent(link->consumer, target))
+			return 1;
+
+	return 0;
+}
+
+static int dpm_reorder_to_tail(struct device *dev, void *not_used)
+{
+	struct dpm_link *link;
+
+	device_pm_move_last(dev);
+	device_for_each_child(dev, NULL, dpm_reorder_to_tail);
+	list_for_each_entry(link, &dev->power.consumers, consumer_node)
+		dpm_reorder_to_tail(link->consumer, NULL);
+
+	return 0;
+}
+
+/**
+ * device_pm_add_supplier - Make @consumer depend on @supplier for PM.
+ * @consumer: Device that needs @supplier to be active.
+ * @supplier: Device @consumer depends on.
+ *
+ * Must not be called during a system sleep transition. The link is
+ * dropped when either device is removed.
+ */
+int device_pm_add_supplier(struct device *consumer, struct device *supplier)
+{
+	struct dpm_link *link;
+	int error = 0;
+
+	if (!consumer || !supplier)
+		return -EINVAL;
+
+	mutex_lock(&dpm_list_mtx);
+	mutex_lock(&dpm_link_mtx);
+
+	if (dpm_is_dependent(consumer, supplier)) {
+		error = -EINVAL;
+		goto out;
+	}
+
+	list_for_each_entry(link, &consumer->power.suppliers, supplier_node)
+		if (link->supplier == supplier)
+			goto out;
+
+	link = kzalloc(sizeof(*link), GFP_KERNEL);
+	if (!link) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	link->supplier = supplier;
+	link->consumer = consumer;
+	list_add_tail(&link->supplier_node, &consumer->power.suppliers);
+	list_add_tail(&link->consumer_node, &supplier->power.consumers);
+	dpm_reorder_to_tail(consumer, NULL);
+
+ out:
+	mutex_unlock(&dpm_link_mtx);
+	mutex_unlock(&dpm_list_mtx);
+	return error;
+}
+EXPORT_SYMBOL_GPL(device_pm_add_supplier);
+
+static void dpm_links_remove(struct device *dev)
+{
+	struct dpm_link *link, *tmp;
+
+	mutex_lock(&dpm_link_mtx);
+	list_for_each_entry_safe(link, tmp, &dev->power.suppliers,
+				 supplier_node) {
+		list_del(&link->supplier_node);
+		list_del(&link->consumer_node);
+		kfree(link);
+	}
+	list_for_each_entry_safe(link, tmp, &dev->power.consumers,
+				 consumer_node) {
+		list_del(&link->supplier_node);
+		list_del(&link->consumer_node);
+		kfree(link);
+	}
+	mutex_unlock(&dpm_link_mtx);
+}
+
 static pm_callback_t pm_op(const struct dev_pm_ops *ops, pm_message_t state)
 {
 	switch (state.event) {
@@ -474,6 +625,7 @@ static int device_resume(struct device *dev, pm_message_t state, bool async)
 	TRACE_RESUME(0);
 
 	dpm_wait(dev->parent, async);
+	dpm_wait_for_suppliers(dev, async);
 	device_lock(dev);
 
 	dev->power.is_prepared = false;
@@ -868,6 +1020,7 @@ static int __device_suspend(struct device *dev, pm_message_t state, bool async)
 	struct dpm_drv_wd_data data;
 
 	dpm_wait_for_children(dev, async);
+	dpm_wait_for_consumers(dev, async);
 
 	if (async_error)
 		goto Complete;
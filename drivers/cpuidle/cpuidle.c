@@ -23,6 +23,7 @@
 #include "cpuidle.h"
 
 DEFINE_PER_CPU(struct cpuidle_device *, cpuidle_devices);
+static DEFINE_PER_CPU(int, cpuidle_cur_state) = -1;
 
 DEFINE_MUTEX(cpuidle_lock);
 DEFINE_MUTEX(latency_notify_lock);
@@ -131,7 +132,9 @@ int cpuidle_idle_call(void)
 	trace_power_start_rcuidle(POWER_CSTATE, next_state, dev->cpu);
 	trace_cpu_idle_rcuidle(next_state, dev->cpu);
 #endif
+	__this_cpu_write(cpuidle_cur_state, next_state);
 	entered_state = cpuidle_enter_ops(dev, drv, next_state);
+	__this_cpu_write(cpuidle_cur_state, -1);
 
 #ifndef CONFIG_ARCH_MSM
 	trace_power_end_rcuidle(dev->cpu);
@@ -154,6 +157,11 @@ int cpuidle_idle_call(void)
 	return 0;
 }
 
+int cpuidle_get_cpu_state(int cpu)
+{
+	return ACCESS_ONCE(per_cpu(cpuidle_cur_state, cpu));
+}
+
 void cpuidle_install_idle_handler(void)
 {
 	if (enabled_devices) {
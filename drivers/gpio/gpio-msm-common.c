@@ -20,6 +20,7 @@
 #include <linux/module.h>
 #include <linux/spinlock.h>
 #include <linux/syscore_ops.h>
+#include <linux/wakelock.h>
 #include <linux/irqdomain.h>
 #include <linux/of.h>
 #include <linux/err.h>
@@ -479,6 +480,7 @@ void msm_gpio_show_resume_irq(void)
 			if(irq != GPIO_PM_USR_INTz + NR_MSM_IRQS) {
 #endif
 				pr_warning("[K][WAKEUP] Resume caused by msmgpio-%d\n", irq - NR_MSM_IRQS);
+				wakelock_set_resume_irq(irq);
 #if defined(CONFIG_ARCH_MSM8960) || defined(CONFIG_ARCH_APQ8064)
 			}
 #endif
@@ -40,6 +40,16 @@
 
 #include "i2c-core.h"
 
+/*
+ * Suspend and resume i2c adapters and clients asynchronously. The driver
+ * core only orders async devices against their parent, so this is off
+ * by default: a client may depend on regulators, GPIOs or a PMIC that
+ * are not its parent. Drivers can declare those with
+ * device_pm_add_supplier() and then call device_enable_async_suspend().
+ */
+static bool async_pm;
+module_param(async_pm, bool, 0444);
+
 
 static DEFINE_MUTEX(core_lock);
 static DEFINE_IDR(i2c_adapter_idr);
@@ -481,6 +491,8 @@ i2c_new_device(struct i2c_adapter *adap, struct i2c_board_info const *info)
 	dev_set_name(&client->dev, "%d-%04x", i2c_adapter_id(adap),
 		     client->addr | ((client->flags & I2C_CLIENT_TEN)
 				     ? 0xa000 : 0));
+	if (async_pm)
+		device_enable_async_suspend(&client->dev);
 	status = device_register(&client->dev);
 	if (status)
 		goto out_err;
@@ -741,6 +753,8 @@ static int i2c_register_adapter(struct i2c_adapter *adap)
 	dev_set_name(&adap->dev, "i2c-%d", adap->nr);
 	adap->dev.bus = &i2c_bus_type;
 	adap->dev.type = &i2c_adapter_type;
+	if (async_pm)
+		device_enable_async_suspend(&adap->dev);
 	res = device_register(&adap->dev);
 	if (res)
 		goto out_list;
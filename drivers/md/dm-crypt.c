@@ -20,6 +20,8 @@
 #include <linux/backing-dev.h>
 #include <linux/atomic.h>
 #include <linux/scatterlist.h>
+#include <linux/percpu.h>
+#include <linux/ktime.h>
 #include <asm/page.h>
 #include <asm/unaligned.h>
 #include <crypto/hash.h>
@@ -54,6 +56,13 @@ struct dm_crypt_io {
 	int error;
 	sector_t sector;
 	struct dm_crypt_io *base_io;
+
+	struct list_head write_list;
+	struct bio_list write_clones;
+	unsigned write_inflight;
+	int write_done;
+
+	ktime_t start;
 };
 
 struct dm_crypt_request {
@@ -94,6 +103,12 @@ struct iv_lmk_private {
 
 enum flags { DM_CRYPT_SUSPENDED, DM_CRYPT_KEY_VALID };
 
+struct crypt_stats {
+	u64 ios[2];
+	u64 sectors[2];
+	u64 nsecs[2];
+};
+
 struct crypt_config {
 	struct dm_dev *dev;
 	sector_t start;
@@ -106,6 +121,13 @@ struct crypt_config {
 	struct workqueue_struct *io_queue;
 	struct workqueue_struct *crypt_queue;
 
+	spinlock_t write_lock;
+	struct list_head write_ios;
+	struct work_struct write_work;
+	atomic_t write_waiters;
+
+	struct crypt_stats __percpu *stats;
+
 	char *cipher;
 	char *cipher_string;
 
@@ -138,6 +160,7 @@ static struct kmem_cache *_crypt_io_pool;
 
 static void clone_init(struct dm_crypt_io *, struct bio *);
 static void kcryptd_queue_crypt(struct dm_crypt_io *io);
+static void kcryptd_queue_write(struct crypt_config *cc);
 static u8 *iv_of_dmreq(struct crypt_config *cc, struct dm_crypt_request *dmreq);
 
 static struct crypto_ablkcipher *any_tfm(struct crypt_config *cc)
@@ -728,7 +751,13 @@ static struct bio *crypt_alloc_buffer(struct dm_crypt_io *io, unsigned size,
 	*out_of_pages = 0;
 
 	for (i = 0; i < nr_iovecs; i++) {
-		page = mempool_alloc(cc->page_pool, gfp_mask);
+		page = mempool_alloc(cc->page_pool, gfp_mask & ~__GFP_WAIT);
+		if (!page && (gfp_mask & __GFP_WAIT)) {
+			atomic_inc(&cc->write_waiters);
+			kcryptd_queue_write(cc);
+			page = mempool_alloc(cc->page_pool, gfp_mask);
+			atomic_dec(&cc->write_waiters);
+		}
 		if (!page) {
 			*out_of_pages = 1;
 			break;
@@ -781,6 +810,10 @@ static struct dm_crypt_io *crypt_io_alloc(struct dm_target *ti,
 	io->base_io = NULL;
 	io->ctx.req = NULL;
 	atomic_set(&io->io_pending, 0);
+	bio_list_init(&io->write_clones);
+	io->write_inflight = 0;
+	io->write_done = 0;
+	io->start = ktime_get();
 
 	return io;
 }
@@ -802,6 +835,16 @@ static void crypt_dec_pending(struct dm_crypt_io *io)
 
 	if (io->ctx.req)
 		mempool_free(io->ctx.req, cc->req_pool);
+
+	if (likely(!base_io) && !error) {
+		int rw = bio_data_dir(base_bio);
+
+		this_cpu_inc(cc->stats->ios[rw]);
+		this_cpu_add(cc->stats->sectors[rw], bio_sectors(base_bio));
+		this_cpu_add(cc->stats->nsecs[rw],
+			     ktime_to_ns(ktime_sub(ktime_get(), io->start)));
+	}
+
 	mempool_free(io, cc->io_pool);
 
 	if (likely(!base_io))
@@ -873,23 +916,14 @@ static int kcryptd_io_read(struct dm_crypt_io *io, gfp_t gfp)
 	return 0;
 }
 
-static void kcryptd_io_write(struct dm_crypt_io *io)
-{
-	struct bio *clone = io->ctx.bio_out;
-	generic_make_request(clone);
-}
-
 static void kcryptd_io(struct work_struct *work)
 {
 	struct dm_crypt_io *io = container_of(work, struct dm_crypt_io, work);
 
-	if (bio_data_dir(io->base_bio) == READ) {
-		crypt_inc_pending(io);
-		if (kcryptd_io_read(io, GFP_NOIO))
-			io->error = -ENOMEM;
-		crypt_dec_pending(io);
-	} else
-		kcryptd_io_write(io);
+	crypt_inc_pending(io);
+	if (kcryptd_io_read(io, GFP_NOIO))
+		io->error = -ENOMEM;
+	crypt_dec_pending(io);
 }
 
 static void kcryptd_queue_io(struct dm_crypt_io *io)
@@ -900,14 +934,69 @@ static void kcryptd_queue_io(struct dm_crypt_io *io)
 	queue_work(cc->io_queue, &io->work);
 }
 
-static void kcryptd_crypt_write_io_submit(struct dm_crypt_io *io, int async)
+/*
+ * Writes are encrypted in parallel, but the encrypted clones are submitted
+ * in the order the bios were mapped: clones of a bio are parked on it until
+ * all earlier bios have submitted all of theirs.  Only kcryptd_write submits,
+ * from the single threaded io queue.  When an allocation of buffer pages has
+ * to wait, parked clones are submitted out of order so that their pages are
+ * returned to the pool.
+ */
+static void kcryptd_write(struct work_struct *work)
+{
+	struct crypt_config *cc = container_of(work, struct crypt_config,
+					       write_work);
+	struct dm_crypt_io *io, *tmp;
+	struct bio_list clones;
+	struct blk_plug plug;
+	struct bio *clone;
+	unsigned long flags;
+	LIST_HEAD(done);
+
+	bio_list_init(&clones);
+
+	spin_lock_irqsave(&cc->write_lock, flags);
+	list_for_each_entry_safe(io, tmp, &cc->write_ios, write_list) {
+		bio_list_merge(&clones, &io->write_clones);
+		bio_list_init(&io->write_clones);
+
+		if (io->write_done && !io->write_inflight)
+			list_move_tail(&io->write_list, &done);
+		else if (!atomic_read(&cc->write_waiters))
+			break;
+	}
+	spin_unlock_irqrestore(&cc->write_lock, flags);
+
+	blk_start_plug(&plug);
+	while ((clone = bio_list_pop(&clones)))
+		generic_make_request(clone);
+	blk_finish_plug(&plug);
+
+	list_for_each_entry_safe(io, tmp, &done, write_list) {
+		list_del(&io->write_list);
+		crypt_dec_pending(io);
+	}
+}
+
+static void kcryptd_queue_write(struct crypt_config *cc)
+{
+	queue_work(cc->io_queue, &cc->write_work);
+}
+
+static void kcryptd_crypt_write_io_submit(struct dm_crypt_io *io)
 {
 	struct bio *clone = io->ctx.bio_out;
 	struct crypt_config *cc = io->target->private;
+	struct dm_crypt_io *base_io = io->base_io ? : io;
+	unsigned long flags;
 
 	if (unlikely(io->error < 0)) {
 		crypt_free_buffer_pages(cc, clone);
 		bio_put(clone);
+		spin_lock_irqsave(&cc->write_lock, flags);
+		base_io->write_inflight--;
+		spin_unlock_irqrestore(&cc->write_lock, flags);
+		kcryptd_queue_write(cc);
 		crypt_dec_pending(io);
 		return;
 	}
@@ -917,21 +1006,25 @@ static void kcryptd_crypt_write_io_submit(struct dm_crypt_io *io, int async)
 
 	clone->bi_sector = cc->start + io->sector;
 
-	if (async)
-		kcryptd_queue_io(io);
-	else
-		generic_make_request(clone);
+	spin_lock_irqsave(&cc->write_lock, flags);
+	bio_list_add(&base_io->write_clones, clone);
+	base_io->write_inflight--;
+	spin_unlock_irqrestore(&cc->write_lock, flags);
+
+	kcryptd_queue_write(cc);
 }
 
 static void kcryptd_crypt_write_convert(struct dm_crypt_io *io)
 {
 	struct crypt_config *cc = io->target->private;
+	struct dm_crypt_io *base_io = io;
 	struct bio *clone;
 	struct dm_crypt_io *new_io;
 	int crypt_finished;
 	unsigned out_of_pages = 0;
 	unsigned remaining = io->base_bio->bi_size;
 	sector_t sector = io->sector;
+	unsigned long flags;
 	int r;
 
 	crypt_inc_pending(io);
@@ -950,6 +1043,10 @@ static void kcryptd_crypt_write_convert(struct dm_crypt_io *io)
 		remaining -= clone->bi_size;
 		sector += bio_sectors(clone);
 
+		spin_lock_irqsave(&cc->write_lock, flags);
+		base_io->write_inflight++;
+		spin_unlock_irqrestore(&cc->write_lock, flags);
+
 		crypt_inc_pending(io);
 
 		r = crypt_convert(cc, &io->ctx);
@@ -959,7 +1056,7 @@ static void kcryptd_crypt_write_convert(struct dm_crypt_io *io)
 
 		
 		if (crypt_finished) {
-			kcryptd_crypt_write_io_submit(io, 0);
+			kcryptd_crypt_write_io_submit(io);
 
 			if (unlikely(r < 0))
 				break;
@@ -991,6 +1088,11 @@ static void kcryptd_crypt_write_convert(struct dm_crypt_io *io)
 		}
 	}
 
+	spin_lock_irqsave(&cc->write_lock, flags);
+	base_io->write_done = 1;
+	spin_unlock_irqrestore(&cc->write_lock, flags);
+	kcryptd_queue_write(cc);
+
 	crypt_dec_pending(io);
 }
 
@@ -1047,7 +1149,7 @@ static void kcryptd_async_done(struct crypto_async_request *async_req,
 	if (bio_data_dir(io->base_bio) == READ)
 		kcryptd_crypt_read_done(io);
 	else
-		kcryptd_crypt_write_io_submit(io, 1);
+		kcryptd_crypt_write_io_submit(io);
 }
 
 static void kcryptd_crypt(struct work_struct *work)
@@ -1193,6 +1295,9 @@ static void crypt_dtr(struct dm_target *ti)
 	if (cc->crypt_queue)
 		destroy_workqueue(cc->crypt_queue);
 
+	if (cc->stats)
+		free_percpu(cc->stats);
+
 	crypt_free_tfms(cc);
 
 	if (cc->bs)
@@ -1476,15 +1581,26 @@ static int crypt_ctr(struct dm_target *ti, unsigned int argc, char **argv)
 	}
 
 	cc->crypt_queue = alloc_workqueue("kcryptd",
-					  WQ_NON_REENTRANT|
 					  WQ_CPU_INTENSIVE|
-					  WQ_MEM_RECLAIM,
-					  1);
+					  WQ_MEM_RECLAIM|
+					  WQ_UNBOUND,
+					  num_possible_cpus());
 	if (!cc->crypt_queue) {
 		ti->error = "Couldn't create kcryptd queue";
 		goto bad;
 	}
 
+	cc->stats = alloc_percpu(struct crypt_stats);
+	if (!cc->stats) {
+		ti->error = "Cannot allocate crypt statistics";
+		goto bad;
+	}
+
+	spin_lock_init(&cc->write_lock);
+	INIT_LIST_HEAD(&cc->write_ios);
+	INIT_WORK(&cc->write_work, kcryptd_write);
+	atomic_set(&cc->write_waiters, 0);
+
 	ti->num_flush_requests = 1;
 	ti->discard_zeroes_data_unsupported = 1;
 
@@ -1514,8 +1630,14 @@ static int crypt_map(struct dm_target *ti, struct bio *bio,
 	if (bio_data_dir(io->base_bio) == READ) {
 		if (kcryptd_io_read(io, GFP_NOWAIT))
 			kcryptd_queue_io(io);
-	} else
+	} else {
+		cc = ti->private;
+		crypt_inc_pending(io);
+		spin_lock_irq(&cc->write_lock);
+		list_add_tail(&io->write_list, &cc->write_ios);
+		spin_unlock_irq(&cc->write_lock);
 		kcryptd_queue_crypt(io);
+	}
 
 	return DM_MAPIO_SUBMITTED;
 }
@@ -1524,11 +1646,28 @@ static void crypt_status(struct dm_target *ti, status_type_t type,
 			 char *result, unsigned int maxlen)
 {
 	struct crypt_config *cc = ti->private;
+	struct crypt_stats st;
 	unsigned i, sz = 0;
+	int cpu, rw;
 
 	switch (type) {
 	case STATUSTYPE_INFO:
-		result[0] = '\0';
+		memset(&st, 0, sizeof(st));
+		for_each_possible_cpu(cpu) {
+			struct crypt_stats *s = per_cpu_ptr(cc->stats, cpu);
+
+			for (rw = READ; rw <= WRITE; rw++) {
+				st.ios[rw] += s->ios[rw];
+				st.sectors[rw] += s->sectors[rw];
+				st.nsecs[rw] += s->nsecs[rw];
+			}
+		}
+		for (rw = READ; rw <= WRITE; rw++)
+			DMEMIT("%s%llu %llu %llu", rw == READ ? "" : " ",
+			       (unsigned long long)st.ios[rw],
+			       (unsigned long long)st.sectors[rw],
+			       (unsigned long long)div_u64(st.nsecs[rw],
+							   NSEC_PER_USEC));
 		break;
 
 	case STATUSTYPE_TABLE:
@@ -1637,7 +1776,7 @@ static int crypt_iterate_devices(struct dm_target *ti,
 
 static struct target_type crypt_target = {
 	.name   = "crypt",
-	.version = {1, 11, 0},
+	.version = {1, 12, 0},
 	.module = THIS_MODULE,
 	.ctr    = crypt_ctr,
 	.dtr    = crypt_dtr,
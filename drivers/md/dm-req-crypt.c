@@ -17,12 +17,15 @@
 #include <linux/bio.h>
 #include <linux/blkdev.h>
 #include <linux/mempool.h>
+#include <linux/mutex.h>
 #include <linux/slab.h>
 #include <linux/crypto.h>
 #include <linux/workqueue.h>
 #include <linux/backing-dev.h>
 #include <linux/atomic.h>
 #include <linux/scatterlist.h>
+#include <linux/percpu.h>
+#include <linux/ktime.h>
 #include <crypto/scatterwalk.h>
 #include <asm/page.h>
 #include <asm/unaligned.h>
@@ -41,6 +44,7 @@
 #define MAX_ENCRYPTION_BUFFERS 1
 #define MIN_IOS 16
 #define MIN_POOL_PAGES 32
+#define MIN_SG_POOL 4
 #define KEY_SIZE_XTS 64
 #define AES_XTS_IV_LEN 16
 
@@ -58,14 +62,41 @@ sector_t start_sector_orig;
 struct workqueue_struct *req_crypt_queue;
 mempool_t *req_io_pool;
 mempool_t *req_page_pool;
+mempool_t *req_sg_pool;
 struct crypto_ablkcipher *tfm;
 
+/*
+ * All workers share one tfm, so the pipe key setup is serialized. Each
+ * request takes a single sg pool element that holds both its input and
+ * output tables, so workers never wait on the pool while holding one.
+ */
+static DEFINE_MUTEX(req_crypt_key_lock);
+
+/*
+ * Writes are encrypted in parallel on all cpus, but dispatched in the
+ * order they were mapped. Mapped writes wait on this list until all
+ * writes ahead of them are encrypted.
+ */
+static DEFINE_SPINLOCK(req_crypt_write_lock);
+static LIST_HEAD(req_crypt_write_list);
+
+struct req_crypt_stats {
+	u64 ios[2];
+	u64 sectors[2];
+	u64 nsecs[2];
+};
+
+static DEFINE_PER_CPU(struct req_crypt_stats, req_crypt_stats);
+
 struct req_dm_crypt_io {
 	struct work_struct work;
 	struct request *cloned_request;
 	int error;
 	atomic_t pending;
-	struct timespec start_time;
+	ktime_t start_time;
+	unsigned int sectors;
+	struct list_head write_list;
+	int write_ready;
 };
 
 static void req_crypt_cipher_complete
@@ -77,10 +108,41 @@ static void req_crypt_inc_pending(struct req_dm_crypt_io *io)
 	atomic_inc(&io->pending);
 }
 
+static void req_crypt_account(struct req_dm_crypt_io *io, int rw)
+{
+	this_cpu_inc(req_crypt_stats.ios[rw]);
+	this_cpu_add(req_crypt_stats.sectors[rw], io->sectors);
+	this_cpu_add(req_crypt_stats.nsecs[rw],
+		     ktime_to_ns(ktime_sub(ktime_get(), io->start_time)));
+}
+
+/*
+ * Dispatch the encrypted writes at the head of req_crypt_write_list.
+ */
+static void req_crypt_dispatch_writes(void)
+{
+	struct req_dm_crypt_io *io;
+
+	while (!list_empty(&req_crypt_write_list)) {
+		io = list_first_entry(&req_crypt_write_list,
+				      struct req_dm_crypt_io, write_list);
+		if (!io->write_ready)
+			break;
+
+		list_del(&io->write_list);
+		if (io->error < 0) {
+			dm_kill_unmapped_request(io->cloned_request, io->error);
+			mempool_free(io, req_io_pool);
+		} else
+			dm_dispatch_request(io->cloned_request);
+	}
+}
+
 static void req_crypt_dec_pending_encrypt(struct req_dm_crypt_io *io)
 {
 	int error = 0;
 	struct request *clone = NULL;
+	unsigned long flags;
 
 	if (io) {
 		error = io->error;
@@ -106,11 +168,10 @@ static void req_crypt_dec_pending_encrypt(struct req_dm_crypt_io *io)
 
 	atomic_dec(&io->pending);
 
-	if (error < 0) {
-		dm_kill_unmapped_request(clone, error);
-		mempool_free(io, req_io_pool);
-	} else
-		dm_dispatch_request(clone);
+	spin_lock_irqsave(&req_crypt_write_lock, flags);
+	io->write_ready = 1;
+	req_crypt_dispatch_writes();
+	spin_unlock_irqrestore(&req_crypt_write_lock, flags);
 }
 
 static void req_crypt_dec_pending_decrypt(struct req_dm_crypt_io *io)
@@ -142,11 +203,21 @@ static void req_crypt_dec_pending_decrypt(struct req_dm_crypt_io *io)
 	}
 
 	/* Should never get here if io or Clone is NULL */
+	if (!error)
+		req_crypt_account(io, READ);
 	dm_end_request(clone, error);
 	atomic_dec(&io->pending);
 	mempool_free(io, req_io_pool);
 }
 
+static void req_crypt_set_key(void)
+{
+	mutex_lock(&req_crypt_key_lock);
+	crypto_ablkcipher_clear_flags(tfm, ~0);
+	crypto_ablkcipher_setkey(tfm, NULL, KEY_SIZE_XTS);
+	mutex_unlock(&req_crypt_key_lock);
+}
+
 /*
  * The callback that will be called by the worker queue to perform Decryption
  * for reads and use the dm function to complete the bios and requests.
@@ -198,17 +269,10 @@ static void req_cryptd_crypt_read_convert(struct req_dm_crypt_io *io)
 	init_completion(&result.completion);
 	qcrypto_cipher_set_flag(req,
 		QCRYPTO_CTX_USE_PIPE_KEY | QCRYPTO_CTX_XTS_DU_SIZE_512B);
-	crypto_ablkcipher_clear_flags(tfm, ~0);
-	crypto_ablkcipher_setkey(tfm, NULL, KEY_SIZE_XTS);
+	req_crypt_set_key();
 
-	req_sg_read = kzalloc(sizeof(struct scatterlist) *
-			MAX_SG_LIST, GFP_KERNEL);
-	if (!req_sg_read) {
-		DMERR("%s req_sg_read allocation failed\n",
-						__func__);
-		err = DM_REQ_CRYPT_ERROR;
-		goto ablkcipher_req_alloc_failure;
-	}
+	req_sg_read = mempool_alloc(req_sg_pool, GFP_NOIO);
+	sg_init_table(req_sg_read, MAX_SG_LIST);
 
 	total_sg_len = blk_rq_map_sg(clone->q, clone, req_sg_read);
 	if ((total_sg_len <= 0) || (total_sg_len > MAX_SG_LIST)) {
@@ -261,7 +325,8 @@ ablkcipher_req_alloc_failure:
 	if (req)
 		ablkcipher_request_free(req);
 
-	kfree(req_sg_read);
+	if (req_sg_read)
+		mempool_free(req_sg_read, req_sg_pool);
 
 submit_request:
 	if (io)
@@ -324,26 +389,13 @@ static void req_cryptd_crypt_write_convert(struct req_dm_crypt_io *io)
 	init_completion(&result.completion);
 	qcrypto_cipher_set_flag(req,
 		QCRYPTO_CTX_USE_PIPE_KEY | QCRYPTO_CTX_XTS_DU_SIZE_512B);
-	crypto_ablkcipher_clear_flags(tfm, ~0);
-	crypto_ablkcipher_setkey(tfm, NULL, KEY_SIZE_XTS);
+	req_crypt_set_key();
 
-	req_sg_in = kzalloc(sizeof(struct scatterlist) * MAX_SG_LIST,
-			GFP_KERNEL);
-	if (!req_sg_in) {
-		DMERR("%s req_sg_in allocation failed\n",
-					__func__);
-		error = DM_REQ_CRYPT_ERROR;
-		goto ablkcipher_req_alloc_failure;
-	}
+	req_sg_in = mempool_alloc(req_sg_pool, GFP_NOIO);
+	sg_init_table(req_sg_in, MAX_SG_LIST);
 
-	req_sg_out = kzalloc(sizeof(struct scatterlist) * MAX_SG_LIST,
-			GFP_KERNEL);
-	if (!req_sg_out) {
-		DMERR("%s req_sg_out allocation failed\n",
-					__func__);
-		error = DM_REQ_CRYPT_ERROR;
-		goto ablkcipher_req_alloc_failure;
-	}
+	req_sg_out = req_sg_in + MAX_SG_LIST;
+	sg_init_table(req_sg_out, MAX_SG_LIST);
 
 	total_sg_len_req_in = blk_rq_map_sg(clone->q, clone, req_sg_in);
 	if ((total_sg_len_req_in <= 0) ||
@@ -450,9 +502,8 @@ ablkcipher_req_alloc_failure:
 	}
 
 
-	kfree(req_sg_in);
-
-	kfree(req_sg_out);
+	if (req_sg_in)
+		mempool_free(req_sg_in, req_sg_pool);
 
 submit_request:
 	if (io)
@@ -543,6 +594,8 @@ static int req_crypt_endio(struct dm_target *ti, struct request *clone,
 			} else
 				bvec->bv_page = NULL;
 		}
+		if (!error)
+			req_crypt_account(req_io, WRITE);
 		mempool_free(req_io, req_io_pool);
 		goto submit_request;
 	} else if (rq_data_dir(clone) == READ) {
@@ -593,6 +646,9 @@ static int req_crypt_map(struct dm_target *ti, struct request *clone,
 	req_io->cloned_request = clone;
 	map_context->ptr = req_io;
 	atomic_set(&req_io->pending, 0);
+	req_io->error = 0;
+	req_io->start_time = ktime_get();
+	req_io->sectors = blk_rq_sectors(clone);
 
 	/* Get the queue of the underlying original device */
 	clone->q = bdev_get_queue(dev->bdev);
@@ -629,6 +685,10 @@ static int req_crypt_map(struct dm_target *ti, struct request *clone,
 		error = DM_MAPIO_REMAPPED;
 		goto submit_request;
 	} else if (rq_data_dir(clone) == WRITE) {
+		req_io->write_ready = 0;
+		spin_lock(&req_crypt_write_lock);
+		list_add_tail(&req_io->write_list, &req_crypt_write_list);
+		spin_unlock(&req_crypt_write_lock);
 		req_cryptd_queue_crypt(req_io);
 		error = DM_MAPIO_SUBMITTED;
 		goto submit_request;
@@ -653,6 +713,10 @@ static void req_crypt_dtr(struct dm_target *ti)
 		mempool_destroy(req_page_pool);
 		req_page_pool = NULL;
 	}
+	if (req_sg_pool) {
+		mempool_destroy(req_sg_pool);
+		req_sg_pool = NULL;
+	}
 	if (tfm) {
 		crypto_free_ablkcipher(tfm);
 		tfm = NULL;
@@ -704,11 +768,11 @@ static int req_crypt_ctr(struct dm_target *ti, unsigned int argc, char **argv)
 	start_sector_orig = tmpll;
 
 	req_crypt_queue = alloc_workqueue("req_cryptd",
-					WQ_NON_REENTRANT |
+					WQ_UNBOUND |
 					WQ_HIGHPRI |
 					WQ_CPU_INTENSIVE|
 					WQ_MEM_RECLAIM,
-					1);
+					num_possible_cpus());
 	if (!req_crypt_queue) {
 		DMERR("%s req_crypt_queue not allocated\n", __func__);
 		err =  DM_REQ_CRYPT_ERROR;
@@ -737,6 +801,14 @@ static int req_crypt_ctr(struct dm_target *ti, unsigned int argc, char **argv)
 		err =  DM_REQ_CRYPT_ERROR;
 		goto ctr_exit;
 	}
+
+	req_sg_pool = mempool_create_kmalloc_pool(MIN_SG_POOL,
+				2 * sizeof(struct scatterlist) * MAX_SG_LIST);
+	if (!req_sg_pool) {
+		DMERR("%s req_sg_pool not allocated\n", __func__);
+		err =  DM_REQ_CRYPT_ERROR;
+		goto ctr_exit;
+	}
 	err = 0;
 ctr_exit:
 	if (err != 0) {
@@ -752,6 +824,10 @@ ctr_exit:
 			mempool_destroy(req_page_pool);
 			req_page_pool = NULL;
 		}
+		if (req_sg_pool) {
+			mempool_destroy(req_sg_pool);
+			req_sg_pool = NULL;
+		}
 		if (tfm) {
 			crypto_free_ablkcipher(tfm);
 			tfm = NULL;
@@ -766,14 +842,53 @@ static int req_crypt_iterate_devices(struct dm_target *ti,
 	return fn(ti, dev, start_sector_orig, ti->len, data);
 }
 
+/*
+ * Status: <reads> <read sectors> <read usecs> <writes> <write sectors>
+ * <write usecs>, the usecs being the sum of the latencies from map to
+ * completion of the requests.
+ */
+static void req_crypt_status(struct dm_target *ti, status_type_t type,
+			     char *result, unsigned int maxlen)
+{
+	struct req_crypt_stats st;
+	unsigned sz = 0;
+	int cpu, rw;
+
+	switch (type) {
+	case STATUSTYPE_INFO:
+		memset(&st, 0, sizeof(st));
+		for_each_possible_cpu(cpu) {
+			struct req_crypt_stats *s = &per_cpu(req_crypt_stats, cpu);
+
+			for (rw = READ; rw <= WRITE; rw++) {
+				st.ios[rw] += s->ios[rw];
+				st.sectors[rw] += s->sectors[rw];
+				st.nsecs[rw] += s->nsecs[rw];
+			}
+		}
+		for (rw = READ; rw <= WRITE; rw++)
+			DMEMIT("%s%llu %llu %llu", rw == READ ? "" : " ",
+			       (unsigned long long)st.ios[rw],
+			       (unsigned long long)st.sectors[rw],
+			       (unsigned long long)div_u64(st.nsecs[rw],
+							   NSEC_PER_USEC));
+		break;
+
+	case STATUSTYPE_TABLE:
+		result[0] = '\0';
+		break;
+	}
+}
+
 static struct target_type req_crypt_target = {
 	.name   = "req-crypt",
-	.version = {1, 0, 0},
+	.version = {1, 1, 0},
 	.module = THIS_MODULE,
 	.ctr    = req_crypt_ctr,
 	.dtr    = req_crypt_dtr,
 	.map_rq = req_crypt_map,
 	.rq_end_io = req_crypt_endio,
+	.status = req_crypt_status,
 	.iterate_devices = req_crypt_iterate_devices,
 };
 
@@ -12,12 +12,20 @@
  * hash device. Setting this greatly improves performance when data and hash
  * are on the same disk on different partitions on devices with poor random
  * access behavior.
+ *
+ * The optional "check_at_most_once" table argument makes a device remember
+ * which data blocks were already verified, so that blocks that are read
+ * again (e.g. after they were evicted from the page cache) are not hashed
+ * again. This trades protection against modification of the data device
+ * while it is in use for speed.
  */
 
 #include "dm-bufio.h"
 
 #include <linux/module.h>
 #include <linux/device-mapper.h>
+#include <linux/percpu.h>
+#include <linux/vmalloc.h>
 #include <crypto/hash.h>
 
 #define DM_MSG_PREFIX			"verity"
@@ -28,10 +36,22 @@
 
 #define DM_VERITY_MAX_LEVELS		63
 
+#define DM_VERITY_MAX_PARTS		4
+#define DM_VERITY_MIN_PART_BLOCKS	8
+
 static unsigned dm_verity_prefetch_cluster = DM_VERITY_DEFAULT_PREFETCH_SIZE;
 
 module_param_named(prefetch_cluster, dm_verity_prefetch_cluster, uint, S_IRUGO | S_IWUSR);
 
+struct dm_verity_stats {
+	u64 hash_hits;		/* hash blocks found in the dm-bufio cache */
+	u64 hash_misses;	/* hash blocks that had to be read */
+	u64 blocks_verified;	/* data blocks hashed */
+	u64 blocks_cached;	/* data blocks skipped thanks to the bitmap */
+	u64 ios;		/* bios verified */
+	u64 verify_ns;		/* time from data read completion to bio end */
+};
+
 struct dm_verity {
 	struct dm_dev *data_dev;
 	struct dm_dev *hash_dev;
@@ -60,6 +80,17 @@ struct dm_verity {
 
 	struct workqueue_struct *verify_wq;
 
+	unsigned max_parts;	/* max number of works a bio is verified by */
+	unsigned part_size;	/* size of struct dm_verity_part with buffers */
+
+	/* data blocks that were already verified, if check_at_most_once */
+	unsigned long *verified_blocks;
+
+	/* the block a sequential reader is expected to read next */
+	sector_t next_seq_block;
+
+	struct dm_verity_stats __percpu *stats;
+
 	/* starting blocks for each tree level. 0 is the lowest level. */
 	sector_t hash_level_block[DM_VERITY_MAX_LEVELS];
 };
@@ -79,11 +110,37 @@ struct dm_verity_io {
 	struct bio_vec *io_vec;
 	unsigned io_vec_size;
 
-	struct work_struct work;
+	/* the bio is verified by n_parts works running in parallel */
+	unsigned n_parts;
+	atomic_t parts_pending;
+	int error;
+
+	ktime_t start;
 
 	/* A space for short vectors; longer vectors are allocated separately. */
 	struct bio_vec io_vec_inline[DM_VERITY_IO_VEC_INLINE];
 
+	/*
+	 * v->max_parts structures dm_verity_part follow this struct,
+	 * v->part_size bytes apart. Use io_part() to access them.
+	 */
+};
+
+/*
+ * A run of consecutive blocks of one dm_verity_io, verified by one work.
+ */
+struct dm_verity_part {
+	struct dm_verity_io *io;
+
+	sector_t block;
+	unsigned n_blocks;
+
+	/* position of the first block in io->io_vec */
+	unsigned vector;
+	unsigned offset;
+
+	struct work_struct work;
+
 	/*
 	 * Three variably-size fields follow this struct:
 	 *
@@ -95,21 +152,37 @@ struct dm_verity_io {
 	 */
 };
 
-static struct shash_desc *io_hash_desc(struct dm_verity *v, struct dm_verity_io *io)
+static struct dm_verity_part *io_part(struct dm_verity *v, struct dm_verity_io *io,
+				      unsigned i)
+{
+	return (struct dm_verity_part *)((u8 *)(io + 1) + i * v->part_size);
+}
+
+static struct shash_desc *io_hash_desc(struct dm_verity *v, struct dm_verity_part *part)
 {
-	return (struct shash_desc *)(io + 1);
+	return (struct shash_desc *)(part + 1);
 }
 
-static u8 *io_real_digest(struct dm_verity *v, struct dm_verity_io *io)
+static u8 *io_real_digest(struct dm_verity *v, struct dm_verity_part *part)
 {
-	return (u8 *)(io + 1) + v->shash_descsize;
+	return (u8 *)(part + 1) + v->shash_descsize;
 }
 
-static u8 *io_want_digest(struct dm_verity *v, struct dm_verity_io *io)
+static u8 *io_want_digest(struct dm_verity *v, struct dm_verity_part *part)
 {
-	return (u8 *)(io + 1) + v->shash_descsize + v->digest_size;
+	return (u8 *)(part + 1) + v->shash_descsize + v->digest_size;
 }
 
+/*
+ * Prefetch request, processed asynchronously on the verify workqueue.
+ */
+struct dm_verity_prefetch_work {
+	struct work_struct work;
+	struct dm_verity *v;
+	sector_t block;
+	unsigned n_blocks;
+};
+
 /*
  * Auxiliary structure appended to each dm-bufio buffer. If the value
  * hash_verified is nonzero, hash of the block has been verified.
@@ -178,17 +251,17 @@ static void verity_hash_at_level(struct dm_verity *v, sector_t block, int level,
  * Verify hash of a metadata block pertaining to the specified data block
  * ("block" argument) at a specified level ("level" argument).
  *
- * On successful return, io_want_digest(v, io) contains the hash value for
+ * On successful return, io_want_digest(v, part) contains the hash value for
  * a lower tree level or for the data block (if we're at the lowest leve).
  *
  * If "skip_unverified" is true, unverified buffer is skipped and 1 is returned.
  * If "skip_unverified" is false, unverified buffer is hashed and verified
- * against current value of io_want_digest(v, io).
+ * against current value of io_want_digest(v, part).
  */
-static int verity_verify_level(struct dm_verity_io *io, sector_t block,
+static int verity_verify_level(struct dm_verity_part *part, sector_t block,
 			       int level, bool skip_unverified)
 {
-	struct dm_verity *v = io->v;
+	struct dm_verity *v = part->io->v;
 	struct dm_buffer *buf;
 	struct buffer_aux *aux;
 	u8 *data;
@@ -198,9 +271,15 @@ static int verity_verify_level(struct dm_verity_io *io, sector_t block,
 
 	verity_hash_at_level(v, block, level, &hash_block, &offset);
 
-	data = dm_bufio_read(v->bufio, hash_block, &buf);
-	if (unlikely(IS_ERR(data)))
-		return PTR_ERR(data);
+	data = dm_bufio_get(v->bufio, hash_block, &buf);
+	if (likely(!IS_ERR_OR_NULL(data)))
+		this_cpu_inc(v->stats->hash_hits);
+	else {
+		this_cpu_inc(v->stats->hash_misses);
+		data = dm_bufio_read(v->bufio, hash_block, &buf);
+		if (unlikely(IS_ERR(data)))
+			return PTR_ERR(data);
+	}
 
 	aux = dm_bufio_get_aux_data(buf);
 
@@ -213,7 +292,7 @@ static int verity_verify_level(struct dm_verity_io *io, sector_t block,
 			goto release_ret_r;
 		}
 
-		desc = io_hash_desc(v, io);
+		desc = io_hash_desc(v, part);
 		desc->tfm = v->tfm;
 		desc->flags = CRYPTO_TFM_REQ_MAY_SLEEP;
 		r = crypto_shash_init(desc);
@@ -244,13 +323,13 @@ static int verity_verify_level(struct dm_verity_io *io, sector_t block,
 			}
 		}
 
-		result = io_real_digest(v, io);
+		result = io_real_digest(v, part);
 		r = crypto_shash_final(desc, result);
 		if (r < 0) {
 			DMERR("crypto_shash_final failed: %d", r);
 			goto release_ret_r;
 		}
-		if (unlikely(memcmp(result, io_want_digest(v, io), v->digest_size))) {
+		if (unlikely(memcmp(result, io_want_digest(v, part), v->digest_size))) {
 			DMERR_LIMIT("metadata block %llu is corrupted",
 				(unsigned long long)hash_block);
 			v->hash_failed = 1;
@@ -262,7 +341,7 @@ static int verity_verify_level(struct dm_verity_io *io, sector_t block,
 
 	data += offset;
 
-	memcpy(io_want_digest(v, io), data, v->digest_size);
+	memcpy(io_want_digest(v, part), data, v->digest_size);
 
 	dm_bufio_release(buf);
 	return 0;
@@ -274,20 +353,54 @@ release_ret_r:
 }
 
 /*
- * Verify one "dm_verity_io" structure.
+ * Advance the position in the io vector by one data block.
  */
-static int verity_verify_io(struct dm_verity_io *io)
+static void verity_skip_block(struct dm_verity *v, struct dm_verity_io *io,
+			      unsigned *vector, unsigned *offset)
 {
+	unsigned todo = 1 << v->data_dev_block_bits;
+
+	do {
+		struct bio_vec *bv;
+		unsigned len;
+
+		BUG_ON(*vector >= io->io_vec_size);
+		bv = &io->io_vec[*vector];
+		len = bv->bv_len - *offset;
+		if (likely(len >= todo))
+			len = todo;
+		*offset += len;
+		if (likely(*offset == bv->bv_len)) {
+			*offset = 0;
+			(*vector)++;
+		}
+		todo -= len;
+	} while (todo);
+}
+
+/*
+ * Verify one "dm_verity_part" structure.
+ */
+static int verity_verify_part(struct dm_verity_part *part)
+{
+	struct dm_verity_io *io = part->io;
 	struct dm_verity *v = io->v;
 	unsigned b;
 	int i;
-	unsigned vector = 0, offset = 0;
+	unsigned vector = part->vector, offset = part->offset;
 
-	for (b = 0; b < io->n_blocks; b++) {
+	for (b = 0; b < part->n_blocks; b++) {
 		struct shash_desc *desc;
 		u8 *result;
 		int r;
 		unsigned todo;
+		sector_t block = part->block + b;
+
+		if (v->verified_blocks && test_bit(block, v->verified_blocks)) {
+			this_cpu_inc(v->stats->blocks_cached);
+			verity_skip_block(v, io, &vector, &offset);
+			continue;
+		}
 
 		if (likely(v->levels)) {
 			/*
@@ -297,23 +410,23 @@ static int verity_verify_io(struct dm_verity_io *io)
 			 * function returns 0 and we fall back to whole
 			 * chain verification.
 			 */
-			int r = verity_verify_level(io, io->block + b, 0, true);
+			int r = verity_verify_level(part, block, 0, true);
 			if (likely(!r))
 				goto test_block_hash;
 			if (r < 0)
 				return r;
 		}
 
-		memcpy(io_want_digest(v, io), v->root_digest, v->digest_size);
+		memcpy(io_want_digest(v, part), v->root_digest, v->digest_size);
 
 		for (i = v->levels - 1; i >= 0; i--) {
-			int r = verity_verify_level(io, io->block + b, i, false);
+			int r = verity_verify_level(part, block, i, false);
 			if (unlikely(r))
 				return r;
 		}
 
 test_block_hash:
-		desc = io_hash_desc(v, io);
+		desc = io_hash_desc(v, part);
 		desc->tfm = v->tfm;
 		desc->flags = CRYPTO_TFM_REQ_MAY_SLEEP;
 		r = crypto_shash_init(desc);
@@ -365,21 +478,23 @@ test_block_hash:
 			}
 		}
 
-		result = io_real_digest(v, io);
+		result = io_real_digest(v, part);
 		r = crypto_shash_final(desc, result);
 		if (r < 0) {
 			DMERR("crypto_shash_final failed: %d", r);
 			return r;
 		}
-		if (unlikely(memcmp(result, io_want_digest(v, io), v->digest_size))) {
+		if (unlikely(memcmp(result, io_want_digest(v, part), v->digest_size))) {
 			DMERR_LIMIT("data block %llu is corrupted",
-				(unsigned long long)(io->block + b));
+				(unsigned long long)block);
 			v->hash_failed = 1;
 			return -EIO;
 		}
+
+		this_cpu_inc(v->stats->blocks_verified);
+		if (v->verified_blocks)
+			set_bit(block, v->verified_blocks);
 	}
-	BUG_ON(vector != io->io_vec_size);
-	BUG_ON(offset);
 
 	return 0;
 }
@@ -405,38 +520,100 @@ static void verity_finish_io(struct dm_verity_io *io, int error)
 
 static void verity_work(struct work_struct *w)
 {
-	struct dm_verity_io *io = container_of(w, struct dm_verity_io, work);
+	struct dm_verity_part *part = container_of(w, struct dm_verity_part, work);
+	struct dm_verity_io *io = part->io;
+	struct dm_verity *v = io->v;
+	int r;
+
+	r = verity_verify_part(part);
+	if (unlikely(r))
+		io->error = r;
 
-	verity_finish_io(io, verity_verify_io(io));
+	if (!atomic_dec_and_test(&io->parts_pending))
+		return;
+
+	this_cpu_inc(v->stats->ios);
+	this_cpu_add(v->stats->verify_ns,
+		     ktime_to_ns(ktime_sub(ktime_get(), io->start)));
+
+	verity_finish_io(io, io->error);
 }
 
 static void verity_end_io(struct bio *bio, int error)
 {
 	struct dm_verity_io *io = bio->bi_private;
+	unsigned i;
 
 	if (error) {
 		verity_finish_io(io, error);
 		return;
 	}
 
-	INIT_WORK(&io->work, verity_work);
-	queue_work(io->v->verify_wq, &io->work);
+	io->start = ktime_get();
+	io->error = 0;
+	atomic_set(&io->parts_pending, io->n_parts);
+
+	for (i = 0; i < io->n_parts; i++) {
+		struct dm_verity_part *part = io_part(io->v, io, i);
+
+		INIT_WORK(&part->work, verity_work);
+		queue_work(io->v->verify_wq, &part->work);
+	}
 }
 
 /*
- * Prefetch buffers for the specified io.
+ * Split the io into runs of blocks that are verified in parallel.
+ * Small ios are not split, the work overhead would exceed the gain.
+ */
+static void verity_split_io(struct dm_verity *v, struct dm_verity_io *io)
+{
+	unsigned n_parts, per_part, i;
+	sector_t block = io->block;
+	unsigned vector = 0, offset = 0;
+
+	n_parts = DIV_ROUND_UP(io->n_blocks, DM_VERITY_MIN_PART_BLOCKS);
+	n_parts = clamp(n_parts, 1U, v->max_parts);
+	per_part = DIV_ROUND_UP(io->n_blocks, n_parts);
+
+	i = 0;
+	do {
+		struct dm_verity_part *part = io_part(v, io, i++);
+		unsigned b;
+
+		part->io = io;
+		part->block = block;
+		part->n_blocks = min_t(sector_t, per_part,
+				       io->block + io->n_blocks - block);
+		part->vector = vector;
+		part->offset = offset;
+
+		for (b = 0; b < part->n_blocks; b++)
+			verity_skip_block(v, io, &vector, &offset);
+		block += part->n_blocks;
+	} while (block < io->block + io->n_blocks);
+	io->n_parts = i;
+
+	BUG_ON(vector != io->io_vec_size);
+	BUG_ON(offset);
+}
+
+/*
+ * Prefetch buffers for the specified range of data blocks.
  * The root buffer is not prefetched, it is assumed that it will be cached
  * all the time.
  */
-static void verity_prefetch_io(struct dm_verity *v, struct dm_verity_io *io)
+static void verity_prefetch_io(struct work_struct *work)
 {
+	struct dm_verity_prefetch_work *pw =
+		container_of(work, struct dm_verity_prefetch_work, work);
+	struct dm_verity *v = pw->v;
 	int i;
 
 	for (i = v->levels - 2; i >= 0; i--) {
 		sector_t hash_block_start;
 		sector_t hash_block_end;
-		verity_hash_at_level(v, io->block, i, &hash_block_start, NULL);
-		verity_hash_at_level(v, io->block + io->n_blocks - 1, i, &hash_block_end, NULL);
+		verity_hash_at_level(v, pw->block, i, &hash_block_start, NULL);
+		verity_hash_at_level(v, pw->block + pw->n_blocks - 1, i, &hash_block_end, NULL);
 		if (!i) {
 			unsigned cluster = *(volatile unsigned *)&dm_verity_prefetch_cluster;
 
@@ -456,6 +633,34 @@ no_prefetch_cluster:
 		dm_bufio_prefetch(v->bufio, hash_block_start,
 				  hash_block_end - hash_block_start + 1);
 	}
+
+	kfree(pw);
+}
+
+/*
+ * Queue prefetch of the hash blocks for the io. If the io continues where
+ * the previous one ended, the reader is likely sequential (readahead), so
+ * hash blocks for the next window of the same size are prefetched too.
+ */
+static void verity_submit_prefetch(struct dm_verity *v, struct dm_verity_io *io)
+{
+	struct dm_verity_prefetch_work *pw;
+	sector_t n_blocks = io->n_blocks;
+
+	if (io->block == v->next_seq_block)
+		n_blocks = min(n_blocks * 2, v->data_blocks - io->block);
+	v->next_seq_block = io->block + io->n_blocks;
+
+	pw = kmalloc(sizeof(struct dm_verity_prefetch_work),
+		     GFP_NOIO | __GFP_NORETRY | __GFP_NOMEMALLOC | __GFP_NOWARN);
+	if (!pw)
+		return;
+
+	INIT_WORK(&pw->work, verity_prefetch_io);
+	pw->v = v;
+	pw->block = io->block;
+	pw->n_blocks = n_blocks;
+	queue_work(v->verify_wq, &pw->work);
 }
 
 /*
@@ -504,7 +709,9 @@ static int verity_map(struct dm_target *ti, struct bio *bio,
 	memcpy(io->io_vec, bio_iovec(bio),
 	       io->io_vec_size * sizeof(struct bio_vec));
 
-	verity_prefetch_io(v, io);
+	verity_split_io(v, io);
+
+	verity_submit_prefetch(v, io);
 
 	generic_make_request(bio);
 
@@ -512,18 +719,38 @@ static int verity_map(struct dm_target *ti, struct bio *bio,
 }
 
 /*
- * Status: V (valid) or C (corruption found)
+ * Status: V (valid) or C (corruption found), followed by the statistics
  */
 static void verity_status(struct dm_target *ti, status_type_t type,
 			  char *result, unsigned maxlen)
 {
 	struct dm_verity *v = ti->private;
+	struct dm_verity_stats st;
 	unsigned sz = 0;
 	unsigned x;
+	int cpu;
 
 	switch (type) {
 	case STATUSTYPE_INFO:
-		DMEMIT("%c", v->hash_failed ? 'C' : 'V');
+		memset(&st, 0, sizeof(st));
+		for_each_possible_cpu(cpu) {
+			struct dm_verity_stats *s = per_cpu_ptr(v->stats, cpu);
+
+			st.hash_hits += s->hash_hits;
+			st.hash_misses += s->hash_misses;
+			st.blocks_verified += s->blocks_verified;
+			st.blocks_cached += s->blocks_cached;
+			st.ios += s->ios;
+			st.verify_ns += s->verify_ns;
+		}
+		DMEMIT("%c %llu %llu %llu %llu %llu %llu",
+			v->hash_failed ? 'C' : 'V',
+			(unsigned long long)st.hash_hits,
+			(unsigned long long)st.hash_misses,
+			(unsigned long long)st.blocks_verified,
+			(unsigned long long)st.blocks_cached,
+			(unsigned long long)st.ios,
+			(unsigned long long)div_u64(st.verify_ns, NSEC_PER_USEC));
 		break;
 	case STATUSTYPE_TABLE:
 		DMEMIT("%u %s %s %u %u %llu %llu %s ",
@@ -544,6 +771,8 @@ static void verity_status(struct dm_target *ti, status_type_t type,
 		else
 			for (x = 0; x < v->salt_size; x++)
 				DMEMIT("%02x", v->salt[x]);
+		if (v->verified_blocks)
+			DMEMIT(" 1 check_at_most_once");
 		break;
 	}
 }
@@ -614,6 +843,11 @@ static void verity_dtr(struct dm_target *ti)
 	if (v->bufio)
 		dm_bufio_client_destroy(v->bufio);
 
+	if (v->stats)
+		free_percpu(v->stats);
+
+	vfree(v->verified_blocks);
+
 	kfree(v->salt);
 	kfree(v->root_digest);
 
@@ -648,13 +882,19 @@ static void verity_dtr(struct dm_target *ti)
 static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 {
 	struct dm_verity *v;
-	unsigned num;
+	struct dm_arg_set as;
+	const char *opt_string;
+	unsigned num, opt_params;
 	unsigned long long num_ll;
 	int r;
 	int i;
 	sector_t hash_position;
 	char dummy;
 
+	static struct dm_arg _args[] = {
+		{0, 1, "Invalid number of feature args"},
+	};
+
 	v = kzalloc(sizeof(struct dm_verity), GFP_KERNEL);
 	if (!v) {
 		ti->error = "Cannot allocate verity structure";
@@ -669,8 +909,8 @@ static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 		goto bad;
 	}
 
-	if (argc != 10) {
-		ti->error = "Invalid argument count: exactly 10 arguments required";
+	if (argc < 10) {
+		ti->error = "Invalid argument count: at least 10 arguments required";
 		r = -EINVAL;
 		goto bad;
 	}
@@ -838,8 +1078,12 @@ static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 		goto bad;
 	}
 
+	v->max_parts = min_t(unsigned, num_possible_cpus(), DM_VERITY_MAX_PARTS);
+	v->part_size = ALIGN(sizeof(struct dm_verity_part) + v->shash_descsize +
+			     v->digest_size * 2, __alignof__(struct dm_verity_part));
+
 	v->io_mempool = mempool_create_kmalloc_pool(DM_VERITY_MEMPOOL_SIZE,
-	  sizeof(struct dm_verity_io) + v->shash_descsize + v->digest_size * 2);
+	  sizeof(struct dm_verity_io) + v->max_parts * v->part_size);
 	if (!v->io_mempool) {
 		ti->error = "Cannot allocate io mempool";
 		r = -ENOMEM;
@@ -854,8 +1098,53 @@ static int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 		goto bad;
 	}
 
-	/* WQ_UNBOUND greatly improves performance when running on ramdisk */
-	v->verify_wq = alloc_workqueue("kverityd", WQ_CPU_INTENSIVE | WQ_MEM_RECLAIM | WQ_UNBOUND, num_online_cpus());
+	v->stats = alloc_percpu(struct dm_verity_stats);
+	if (!v->stats) {
+		ti->error = "Cannot allocate statistics";
+		r = -ENOMEM;
+		goto bad;
+	}
+
+	as.argc = argc - 10;
+	as.argv = argv + 10;
+	if (as.argc) {
+		r = dm_read_arg_group(_args, &as, &opt_params, &ti->error);
+		if (r)
+			goto bad;
+
+		while (opt_params--) {
+			opt_string = dm_shift_arg(&as);
+			if (!strcasecmp(opt_string, "check_at_most_once") &&
+			    !v->verified_blocks) {
+				v->verified_blocks =
+					vzalloc(BITS_TO_LONGS(v->data_blocks) *
+						sizeof(unsigned long));
+				if (!v->verified_blocks) {
+					ti->error = "Cannot allocate verified blocks bitmap";
+					r = -ENOMEM;
+					goto bad;
+				}
+				continue;
+			}
+
+			ti->error = "Unrecognized verity feature request";
+			r = -EINVAL;
+			goto bad;
+		}
+
+		if (as.argc) {
+			ti->error = "Too many arguments";
+			r = -EINVAL;
+			goto bad;
+		}
+	}
+
+	/*
+	 * WQ_UNBOUND greatly improves performance when running on ramdisk.
+	 * Allow a work per possible cpu, so that the parts of an io are
+	 * verified in parallel even if cpus were offline when it was created.
+	 */
+	v->verify_wq = alloc_workqueue("kverityd", WQ_CPU_INTENSIVE | WQ_MEM_RECLAIM | WQ_UNBOUND, num_possible_cpus());
 	if (!v->verify_wq) {
 		ti->error = "Cannot allocate workqueue";
 		r = -ENOMEM;
@@ -872,7 +1161,7 @@ bad:
 
 static struct target_type verity_target = {
 	.name		= "verity",
-	.version	= {1, 0, 0},
+	.version	= {1, 1, 0},
 	.module		= THIS_MODULE,
 	.ctr		= verity_ctr,
 	.dtr		= verity_dtr,
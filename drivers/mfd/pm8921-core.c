@@ -26,6 +26,7 @@
 #include <linux/mfd/pm8xxx/regulator.h>
 #include <linux/leds-pm8xxx.h>
 #include <linux/syscore_ops.h>
+#include <linux/wakelock.h>
 
 #define REG_HWREV		0x002  
 #define REG_HWREV_2		0x0E8  
@@ -883,6 +884,7 @@ static void pm8921_show_resume_irq(void)
 				__func__, irq);
 				printk("[K][WAKEUP] Resume caused by pmic-%d\n",
 				irq - (NR_MSM_IRQS + NR_GPIO_IRQS));
+				wakelock_set_resume_irq(irq);
 			}
 		}
 	}
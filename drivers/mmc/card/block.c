@@ -63,12 +63,21 @@ MODULE_ALIAS("mmc:block");
 			(req->cmd_flags & REQ_META)) && \
 			(rq_data_dir(req) == WRITE))
 #define PACKED_CMD_VER		0x01
+#define PACKED_CMD_RD		0x01
 #define PACKED_CMD_WR		0x02
 #define MMC_BLK_UPDATE_STOP_REASON(stats, reason)			\
 	do {								\
 		if (stats->enabled)					\
 			stats->pack_stop_reason[reason]++;		\
 	} while (0)
+#define MMC_BLK_UPDATE_URGENT_STATS(card, field)			\
+	do {								\
+		unsigned long __flags;					\
+		spin_lock_irqsave(&(card)->urgent_stats.lock, __flags);	\
+		(card)->urgent_stats.field++;				\
+		spin_unlock_irqrestore(&(card)->urgent_stats.lock,	\
+				       __flags);			\
+	} while (0)
 
 static DEFINE_MUTEX(block_mutex);
 
@@ -1348,6 +1357,51 @@ static int sd_blk_err_check(struct mmc_card *card,
 	return MMC_BLK_SUCCESS;
 }
 
+static int mmc_blk_packed_rd_issue(struct mmc_card *card,
+				   struct mmc_queue_req *mq_rq)
+{
+	struct mmc_blk_request *hdr = &mq_rq->packed_hdr_brq;
+	struct request *req = mq_rq->req;
+	unsigned long timeout;
+	u32 status;
+	int err;
+
+	if (hdr->sbc.error || hdr->cmd.error || hdr->stop.error ||
+	    hdr->data.error) {
+		pr_err("%s: packed read header failed, sbc %d cmd %d data %d stop %d\n",
+		       req->rq_disk->disk_name, hdr->sbc.error,
+		       hdr->cmd.error, hdr->data.error, hdr->stop.error);
+		return MMC_BLK_RETRY;
+	}
+
+	if (hdr->cmd.resp[0] & CMD_ERRORS) {
+		pr_err("%s: packed read header rejected, status = %#x\n",
+		       req->rq_disk->disk_name, hdr->cmd.resp[0]);
+		return MMC_BLK_ABORT;
+	}
+
+	if (!mmc_host_is_spi(card->host)) {
+		timeout = jiffies + HZ * 2;
+		do {
+			err = get_card_status(card, &status, 5);
+			if (err) {
+				pr_err("%s: error %d requesting status\n",
+				       req->rq_disk->disk_name, err);
+				return MMC_BLK_CMD_ERR;
+			}
+			if (time_after(jiffies, timeout)) {
+				pr_err("%s: card not ready after packed read header, status %#x\n",
+				       req->rq_disk->disk_name, status);
+				return MMC_BLK_RETRY;
+			}
+		} while (!(status & R1_READY_FOR_DATA) ||
+			 (R1_CURRENT_STATE(status) == R1_STATE_PRG));
+	}
+
+	mmc_wait_for_req(card->host, &mq_rq->brq.mrq);
+	return MMC_BLK_SUCCESS;
+}
+
 static int mmc_blk_packed_err_check(struct mmc_card *card,
 				    struct mmc_async_req *areq)
 {
@@ -1357,6 +1411,12 @@ static int mmc_blk_packed_err_check(struct mmc_card *card,
 	int err, check, status;
 	u8 ext_csd[512];
 
+	if (mq_rq->packed_cmd == MMC_PACKED_READ) {
+		check = mmc_blk_packed_rd_issue(card, mq_rq);
+		if (check != MMC_BLK_SUCCESS)
+			return check;
+	}
+
 	check = mmc_blk_err_check(card, areq);
 	err = get_card_status(card, &status, 0);
 	if (err) {
@@ -1547,84 +1607,175 @@ struct mmc_wr_pack_stats *mmc_blk_get_packed_statistics(struct mmc_card *card)
 }
 EXPORT_SYMBOL(mmc_blk_get_packed_statistics);
 
-void mmc_blk_init_packed_statistics(struct mmc_card *card)
+struct mmc_wr_pack_stats *mmc_blk_get_rd_packed_statistics(
+		struct mmc_card *card)
 {
-	int max_num_of_packed_reqs = 0;
+	if (!card)
+		return NULL;
 
-	if (!card || !card->wr_pack_stats.packing_events)
-		return;
+	return &card->rd_pack_stats;
+}
+EXPORT_SYMBOL(mmc_blk_get_rd_packed_statistics);
 
-	max_num_of_packed_reqs = card->ext_csd.max_packed_writes;
+static void mmc_blk_reset_pack_stats(struct mmc_wr_pack_stats *stats,
+				     int max_num_of_packed_reqs)
+{
+	if (!stats->packing_events)
+		return;
 
-	spin_lock(&card->wr_pack_stats.lock);
-	memset(card->wr_pack_stats.packing_events, 0,
+	spin_lock(&stats->lock);
+	memset(stats->packing_events, 0,
 		(max_num_of_packed_reqs + 1) *
-	       sizeof(*card->wr_pack_stats.packing_events));
-	memset(&card->wr_pack_stats.pack_stop_reason, 0,
-		sizeof(card->wr_pack_stats.pack_stop_reason));
-	card->wr_pack_stats.enabled = true;
-	spin_unlock(&card->wr_pack_stats.lock);
+	       sizeof(*stats->packing_events));
+	memset(&stats->pack_stop_reason, 0,
+		sizeof(stats->pack_stop_reason));
+	stats->enabled = true;
+	spin_unlock(&stats->lock);
+}
+
+void mmc_blk_init_packed_statistics(struct mmc_card *card)
+{
+	if (!card)
+		return;
+
+	mmc_blk_reset_pack_stats(&card->wr_pack_stats,
+				 card->ext_csd.max_packed_writes);
 }
 EXPORT_SYMBOL(mmc_blk_init_packed_statistics);
 
-void print_mmc_packing_stats(struct mmc_card *card)
+void mmc_blk_init_rd_packed_statistics(struct mmc_card *card)
+{
+	if (!card)
+		return;
+
+	mmc_blk_reset_pack_stats(&card->rd_pack_stats,
+				 card->ext_csd.max_packed_reads);
+}
+EXPORT_SYMBOL(mmc_blk_init_rd_packed_statistics);
+
+static void print_mmc_pack_stats(struct mmc_card *card,
+				 struct mmc_wr_pack_stats *stats,
+				 int max_num_of_packed_reqs, const char *dir)
 {
 	int i;
-	int max_num_of_packed_reqs = 0;
 
-	if ((!card) || (!card->wr_pack_stats.packing_events))
+	if (!stats->packing_events)
 		return;
 
-	max_num_of_packed_reqs = card->ext_csd.max_packed_writes;
-
-	spin_lock(&card->wr_pack_stats.lock);
+	spin_lock(&stats->lock);
 
-	pr_info("%s: write packing statistics:\n",
-		mmc_hostname(card->host));
+	pr_info("%s: %s packing statistics:\n",
+		mmc_hostname(card->host), dir);
 
 	for (i = 1 ; i <= max_num_of_packed_reqs ; ++i) {
-		if (card->wr_pack_stats.packing_events[i] != 0)
+		if (stats->packing_events[i] != 0)
 			pr_info("%s: Packed %d reqs - %d times\n",
 				mmc_hostname(card->host), i,
-				card->wr_pack_stats.packing_events[i]);
+				stats->packing_events[i]);
 	}
 
 	pr_info("%s: stopped packing due to the following reasons:\n",
 		mmc_hostname(card->host));
 
-	if (card->wr_pack_stats.pack_stop_reason[EXCEEDS_SEGMENTS])
+	if (stats->pack_stop_reason[EXCEEDS_SEGMENTS])
 		pr_info("%s: %d times: exceedmax num of segments\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[EXCEEDS_SEGMENTS]);
-	if (card->wr_pack_stats.pack_stop_reason[EXCEEDS_SECTORS])
+			stats->pack_stop_reason[EXCEEDS_SEGMENTS]);
+	if (stats->pack_stop_reason[EXCEEDS_SECTORS])
 		pr_info("%s: %d times: exceeding the max num of sectors\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[EXCEEDS_SECTORS]);
-	if (card->wr_pack_stats.pack_stop_reason[WRONG_DATA_DIR])
+			stats->pack_stop_reason[EXCEEDS_SECTORS]);
+	if (stats->pack_stop_reason[WRONG_DATA_DIR])
 		pr_info("%s: %d times: wrong data direction\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[WRONG_DATA_DIR]);
-	if (card->wr_pack_stats.pack_stop_reason[FLUSH_OR_DISCARD])
+			stats->pack_stop_reason[WRONG_DATA_DIR]);
+	if (stats->pack_stop_reason[FLUSH_OR_DISCARD])
 		pr_info("%s: %d times: flush or discard\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[FLUSH_OR_DISCARD]);
-	if (card->wr_pack_stats.pack_stop_reason[EMPTY_QUEUE])
+			stats->pack_stop_reason[FLUSH_OR_DISCARD]);
+	if (stats->pack_stop_reason[EMPTY_QUEUE])
 		pr_info("%s: %d times: empty queue\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[EMPTY_QUEUE]);
-	if (card->wr_pack_stats.pack_stop_reason[REL_WRITE])
+			stats->pack_stop_reason[EMPTY_QUEUE]);
+	if (stats->pack_stop_reason[REL_WRITE])
 		pr_info("%s: %d times: rel write\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[REL_WRITE]);
-	if (card->wr_pack_stats.pack_stop_reason[THRESHOLD])
+			stats->pack_stop_reason[REL_WRITE]);
+	if (stats->pack_stop_reason[THRESHOLD])
 		pr_info("%s: %d times: Threshold\n",
 			mmc_hostname(card->host),
-			card->wr_pack_stats.pack_stop_reason[THRESHOLD]);
+			stats->pack_stop_reason[THRESHOLD]);
+
+	spin_unlock(&stats->lock);
+}
+
+void print_mmc_packing_stats(struct mmc_card *card)
+{
+	if (!card)
+		return;
 
-	spin_unlock(&card->wr_pack_stats.lock);
+	print_mmc_pack_stats(card, &card->wr_pack_stats,
+			     card->ext_csd.max_packed_writes, "write");
+	print_mmc_pack_stats(card, &card->rd_pack_stats,
+			     card->ext_csd.max_packed_reads, "read");
 }
 EXPORT_SYMBOL(print_mmc_packing_stats);
 
+static void mmc_blk_urgent_issued(struct mmc_queue *mq)
+{
+	struct mmc_urgent_stats *stats = &mq->card->urgent_stats;
+	unsigned long flags;
+	u32 wait_us;
+
+	wait_us = ktime_to_us(ktime_sub(ktime_get(), mq->urgent_stime));
+	mq->urgent_pending = false;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	stats->issued++;
+	stats->wait_us += wait_us;
+	if (wait_us > stats->max_wait_us)
+		stats->max_wait_us = wait_us;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+static void mmc_blk_account_wr_pack(struct mmc_queue *mq,
+				    struct mmc_queue_req *mq_rq,
+				    enum mmc_blk_status status)
+{
+	struct mmc_urgent_stats *stats = &mq->card->urgent_stats;
+	unsigned long flags;
+	s64 us;
+
+	if (!ktime_to_ns(mq_rq->pack_stime))
+		return;
+
+	us = ktime_to_us(ktime_sub(ktime_get(), mq_rq->pack_stime));
+	mq_rq->pack_stime = ktime_set(0, 0);
+	if (status != MMC_BLK_SUCCESS)
+		return;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	stats->wr_pack_sectors += mq_rq->packed_blocks;
+	stats->wr_pack_us += us;
+	spin_unlock_irqrestore(&stats->lock, flags);
+}
+
+static bool mmc_blk_urgent_capable(struct mmc_queue *mq)
+{
+	struct request_queue *q = mq->queue;
+
+	return q->urgent_request_fn &&
+		q->elevator->type->ops.elevator_is_urgent_fn &&
+		blk_reinsert_req_sup(q);
+}
+
+static bool mmc_blk_urgent_waiting(struct mmc_queue *mq)
+{
+	struct request_queue *q = mq->queue;
+
+	return q->notified_urgent && !q->dispatched_urgent;
+}
+
 static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 {
 	struct request_queue *q = mq->queue;
@@ -1637,7 +1788,7 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 	u8 put_back = 0;
 	u8 max_packed_rw = 0;
 	u8 reqs = 0;
-	struct mmc_wr_pack_stats *stats = &card->wr_pack_stats;
+	struct mmc_wr_pack_stats *stats;
 
 	mmc_blk_clear_packed(mq->mqrq_cur);
 
@@ -1645,12 +1796,16 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 			!card->ext_csd.packed_event_en)
 		goto no_packed;
 
-	if (!mq->wr_packing_enabled)
-		goto no_packed;
-
-	if ((rq_data_dir(cur) == WRITE) &&
-			(card->host->caps2 & MMC_CAP2_PACKED_WR))
-		max_packed_rw = card->ext_csd.max_packed_writes;
+	if (rq_data_dir(cur) == READ) {
+		if (card->host->caps2 & MMC_CAP2_PACKED_RD)
+			max_packed_rw = card->ext_csd.max_packed_reads;
+		stats = &card->rd_pack_stats;
+	} else {
+		if (mq->wr_packing_enabled &&
+				(card->host->caps2 & MMC_CAP2_PACKED_WR))
+			max_packed_rw = card->ext_csd.max_packed_writes;
+		stats = &card->wr_pack_stats;
+	}
 
 	if (max_packed_rw == 0)
 		goto no_packed;
@@ -1678,6 +1833,11 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 	spin_lock(&stats->lock);
 
 	while (reqs < max_packed_rw - 1) {
+		if (rq_data_dir(cur) == WRITE && mmc_blk_urgent_waiting(mq)) {
+			MMC_BLK_UPDATE_URGENT_STATS(card, pack_stopped);
+			break;
+		}
+
 		spin_lock_irq(q->queue_lock);
 		next = blk_fetch_request(q);
 		spin_unlock_irq(q->queue_lock);
@@ -1722,6 +1882,9 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 			break;
 		}
 
+		if ((next->cmd_flags & REQ_URGENT) && mq->urgent_pending)
+			mmc_blk_urgent_issued(mq);
+
 		if (rq_data_dir(next) == WRITE)
 			mq->num_of_potential_packed_wr_reqs++;
 		list_add_tail(&next->queuelist, &mq->mqrq_cur->packed_list);
@@ -1736,7 +1899,7 @@ static u8 mmc_blk_prep_packed_list(struct mmc_queue *mq, struct request *req)
 	}
 
 	if (stats->enabled) {
-		if (reqs + 1 <= card->ext_csd.max_packed_writes)
+		if (reqs + 1 <= max_packed_rw)
 			stats->packing_events[reqs + 1]++;
 		if (reqs + 1 == max_packed_rw)
 			MMC_BLK_UPDATE_STOP_REASON(stats, THRESHOLD);
@@ -1831,6 +1994,113 @@ static void mmc_blk_packed_hdr_wrq_prep(struct mmc_queue_req *mqrq,
 	mmc_queue_bounce_pre(mqrq);
 }
 
+static void mmc_blk_packed_hdr_rrq_prep(struct mmc_queue_req *mqrq,
+					struct mmc_card *card,
+					struct mmc_queue *mq)
+{
+	struct mmc_blk_request *brq = &mqrq->brq;
+	struct mmc_blk_request *hdr = &mqrq->packed_hdr_brq;
+	struct request *req = mqrq->req;
+	struct request *prq;
+	u32 *packed_cmd_hdr = mqrq->packed_cmd_hdr;
+	u8 i = 1;
+
+	mqrq->packed_cmd = MMC_PACKED_READ;
+	mqrq->packed_blocks = 0;
+	mqrq->packed_fail_idx = MMC_PACKED_N_IDX;
+
+	memset(packed_cmd_hdr, 0, sizeof(mqrq->packed_cmd_hdr));
+	packed_cmd_hdr[0] = (mqrq->packed_num << 16) |
+		(PACKED_CMD_RD << 8) | PACKED_CMD_VER;
+
+	list_for_each_entry(prq, &mqrq->packed_list, queuelist) {
+		packed_cmd_hdr[(i * 2)] = blk_rq_sectors(prq);
+		packed_cmd_hdr[((i * 2)) + 1] =
+			mmc_card_blockaddr(card) ?
+			blk_rq_pos(prq) : blk_rq_pos(prq) << 9;
+		mqrq->packed_blocks += blk_rq_sectors(prq);
+		i++;
+	}
+
+	memset(hdr, 0, sizeof(struct mmc_blk_request));
+	hdr->mrq.cmd = &hdr->cmd;
+	hdr->mrq.data = &hdr->data;
+	hdr->mrq.sbc = &hdr->sbc;
+	hdr->mrq.stop = &hdr->stop;
+
+	hdr->sbc.opcode = MMC_SET_BLOCK_COUNT;
+	hdr->sbc.arg = MMC_CMD23_ARG_PACKED | 1;
+	hdr->sbc.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	hdr->cmd.opcode = MMC_WRITE_MULTIPLE_BLOCK;
+	hdr->cmd.arg = blk_rq_pos(req);
+	if (!mmc_card_blockaddr(card))
+		hdr->cmd.arg <<= 9;
+	hdr->cmd.flags = MMC_RSP_SPI_R1 | MMC_RSP_R1 | MMC_CMD_ADTC;
+
+	hdr->data.blksz = 512;
+	hdr->data.blocks = 1;
+	hdr->data.flags |= MMC_DATA_WRITE;
+
+	hdr->stop.opcode = MMC_STOP_TRANSMISSION;
+	hdr->stop.arg = 0;
+	hdr->stop.flags = MMC_RSP_SPI_R1B | MMC_RSP_R1B | MMC_CMD_AC;
+
+	mmc_set_data_timeout(&hdr->data, card);
+
+	memset(brq, 0, sizeof(struct mmc_blk_request));
+	brq->mrq.cmd = &brq->cmd;
+	brq->mrq.data = &brq->data;
+	brq->mrq.sbc = &brq->sbc;
+	brq->mrq.stop = &brq->stop;
+
+	brq->sbc.opcode = MMC_SET_BLOCK_COUNT;
+	brq->sbc.arg = MMC_CMD23_ARG_PACKED | mqrq->packed_blocks;
+	brq->sbc.flags = MMC_RSP_R1 | MMC_CMD_AC;
+
+	brq->cmd.opcode = MMC_READ_MULTIPLE_BLOCK;
+	brq->cmd.arg = hdr->cmd.arg;
+	brq->cmd.flags = MMC_RSP_SPI_R1 | MMC_RSP_R1 | MMC_CMD_ADTC;
+
+	brq->data.blksz = 512;
+	brq->data.blocks = mqrq->packed_blocks;
+	brq->data.flags |= MMC_DATA_READ;
+
+	brq->stop.opcode = MMC_STOP_TRANSMISSION;
+	brq->stop.arg = 0;
+	brq->stop.flags = MMC_RSP_SPI_R1B | MMC_RSP_R1B | MMC_CMD_AC;
+
+	mmc_set_data_timeout(&brq->data, card);
+
+	brq->data.sg = mqrq->sg;
+	brq->data.sg_len = mmc_queue_map_sg(mq, mqrq);
+
+	hdr->data.sg = &mqrq->packed_hdr_sg;
+	hdr->data.sg_len = 1;
+
+	mqrq->mmc_active.mrq = &hdr->mrq;
+
+	if (mq->err_check_fn)
+		mqrq->mmc_active.err_check = mq->err_check_fn;
+	else
+		mqrq->mmc_active.err_check = mmc_blk_packed_err_check;
+
+	if (mq->packed_test_fn)
+		mq->packed_test_fn(mq->queue, mqrq);
+
+	mmc_queue_bounce_pre(mqrq);
+}
+
+static void mmc_blk_packed_prep(struct mmc_queue_req *mqrq,
+				struct mmc_card *card,
+				struct mmc_queue *mq)
+{
+	if (rq_data_dir(mqrq->req) == READ)
+		mmc_blk_packed_hdr_rrq_prep(mqrq, card, mq);
+	else
+		mmc_blk_packed_hdr_wrq_prep(mqrq, card, mq);
+}
+
 static int mmc_blk_cmd_err(struct mmc_blk_data *md, struct mmc_card *card,
 			   struct mmc_blk_request *brq, struct request *req,
 			   int ret)
@@ -1891,6 +2161,54 @@ static int mmc_blk_end_packed_req(struct mmc_queue *mq,
 	return ret;
 }
 
+static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc);
+
+static bool mmc_blk_preempt_packed_wr(struct mmc_queue *mq)
+{
+	struct mmc_card *card = mq->card;
+	struct mmc_queue_req *mqrq = mq->mqrq_cur;
+	struct request_queue *q = mq->queue;
+	struct mmc_urgent_stats *stats = &card->urgent_stats;
+	struct request *prq;
+	unsigned int reqs = 0, sectors = 0;
+	unsigned long flags;
+
+	if (card->host->areq)
+		mmc_blk_issue_rw_rq(mq, NULL);
+
+	if (!mmc_blk_urgent_waiting(mq))
+		return false;
+
+	spin_lock_irq(q->queue_lock);
+	while (!list_empty(&mqrq->packed_list)) {
+		prq = list_entry_rq(mqrq->packed_list.prev);
+		list_del_init(&prq->queuelist);
+		reqs++;
+		sectors += blk_rq_sectors(prq);
+		if (blk_reinsert_request(q, prq)) {
+			pr_err("%s: failed to reinsert preempted request\n",
+			       mmc_hostname(card->host));
+			__blk_end_request_all(prq, -EIO);
+		}
+	}
+	spin_unlock_irq(q->queue_lock);
+
+	mmc_blk_clear_packed(mqrq);
+	mqrq->req = NULL;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	stats->preempted_packs++;
+	stats->preempted_reqs += reqs;
+	stats->preempted_sectors += sectors;
+	if (stats->wr_pack_sectors)
+		stats->saved_us += div64_u64(stats->wr_pack_us * sectors,
+					     stats->wr_pack_sectors);
+	spin_unlock_irqrestore(&stats->lock, flags);
+
+	mmc_release_host(card->host);
+	return true;
+}
+
 static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 {
 	struct mmc_blk_data *md = mq->data;
@@ -1908,14 +2226,21 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 	if (!rqc && !mq->mqrq_prev->req)
 		return 0;
 
-	if (rqc)
+	if (rqc) {
 		reqs = mmc_blk_prep_packed_list(mq, rqc);
+		if (reqs >= packed_num && rq_data_dir(rqc) == WRITE &&
+		    mmc_blk_urgent_capable(mq)) {
+			if (mmc_blk_urgent_waiting(mq) &&
+			    mmc_blk_preempt_packed_wr(mq))
+				return 0;
+			mq->mqrq_cur->pack_stime = ktime_get();
+		}
+	}
 
 	do {
 		if (rqc) {
 			if (reqs >= packed_num)
-				mmc_blk_packed_hdr_wrq_prep(mq->mqrq_cur,
-						card, mq);
+				mmc_blk_packed_prep(mq->mqrq_cur, card, mq);
 			else
 				mmc_blk_rw_rq_prep(mq->mqrq_cur, card, 0, mq);
 			areq = &mq->mqrq_cur->mmc_active;
@@ -1941,6 +2266,9 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 			mmc_blk_reset_success(md, type);
 
 			if (mq_rq->packed_cmd != MMC_PACKED_NONE) {
+				if (mq_rq->packed_cmd == MMC_PACKED_WRITE)
+					mmc_blk_account_wr_pack(mq, mq_rq,
+							status);
 				ret = mmc_blk_end_packed_req(mq, mq_rq);
 				break;
 			} else {
@@ -1960,7 +2288,7 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 		case MMC_BLK_RETRY:
 		case MMC_BLK_ABORT:
 		case MMC_BLK_DATA_ERR:
-			
+			mq_rq->pack_stime = ktime_set(0, 0);
 			pr_info("%s: %s status %d retry %d\n", mmc_hostname(card->host),
 					__func__, status, retry);
 			if (!did_reinit) {
@@ -2015,7 +2343,7 @@ static int mmc_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 				mmc_start_req(card->host,
 						&mq_rq->mmc_active, NULL);
 			} else {
-				mmc_blk_packed_hdr_wrq_prep(mq_rq, card, mq);
+				mmc_blk_packed_prep(mq_rq, card, mq);
 				mmc_start_req(card->host,
 						&mq_rq->mmc_active, NULL);
 			}
@@ -2094,6 +2422,9 @@ static int mmc_blk_issue_rq(struct mmc_queue *mq, struct request *req)
 
 	mmc_blk_write_packing_control(mq, req);
 
+	if (req && (req->cmd_flags & REQ_URGENT) && mq->urgent_pending)
+		mmc_blk_urgent_issued(mq);
+
 	if (req && req->cmd_flags & REQ_SANITIZE) {
 		
 		if (card->host && card->host->areq)
@@ -2148,8 +2479,7 @@ static int sd_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 	do {
 		if (rqc) {
 			if (reqs >= packed_num)
-				mmc_blk_packed_hdr_wrq_prep(mq->mqrq_cur,
-						card, mq);
+				mmc_blk_packed_prep(mq->mqrq_cur, card, mq);
 			else
 				mmc_blk_rw_rq_prep(mq->mqrq_cur, card, 0, mq);
 			areq = &mq->mqrq_cur->mmc_active;
@@ -2251,7 +2581,7 @@ static int sd_blk_issue_rw_rq(struct mmc_queue *mq, struct request *rqc)
 				mmc_start_req(card->host,
 						&mq_rq->mmc_active, NULL);
 			} else {
-				mmc_blk_packed_hdr_wrq_prep(mq_rq, card, mq);
+				mmc_blk_packed_prep(mq_rq, card, mq);
 				mmc_start_req(card->host,
 						&mq_rq->mmc_active, NULL);
 			}
@@ -66,6 +66,7 @@ static int mmc_queue_thread(void *d)
 		spin_unlock_irq(q->queue_lock);
 
 		if (req || mq->mqrq_prev->req) {
+			mmc_stop_idle_time_bkops(mq->card);
 			if (mmc_card_doing_bkops(mq->card)
 				|| mmc_card_doing_sanitize(mq->card))
 				mmc_interrupt_bkops(mq->card);
@@ -79,6 +80,7 @@ static int mmc_queue_thread(void *d)
 			}
 
 			mmc_start_bkops(mq->card);
+			mmc_start_idle_time_bkops(mq->card);
 			up(&mq->thread_sem);
 			schedule();
 			down(&mq->thread_sem);
@@ -159,6 +161,30 @@ static void mmc_request(struct request_queue *q)
 		wake_up_process(mq->thread);
 }
 
+static void mmc_urgent_request(struct request_queue *q)
+{
+	struct mmc_queue *mq = q->queuedata;
+	struct mmc_urgent_stats *stats;
+	unsigned long flags;
+
+	if (!mq) {
+		mmc_request(q);
+		return;
+	}
+
+	if (!mq->urgent_pending) {
+		stats = &mq->card->urgent_stats;
+		spin_lock_irqsave(&stats->lock, flags);
+		stats->notified++;
+		spin_unlock_irqrestore(&stats->lock, flags);
+
+		mq->urgent_stime = ktime_get();
+		mq->urgent_pending = true;
+	}
+
+	mmc_request(q);
+}
+
 static struct scatterlist *mmc_alloc_sg(int sg_len, int *err)
 {
 	struct scatterlist *sg;
@@ -227,6 +253,8 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card,
 	mq->num_wr_reqs_to_start_packing = DEFAULT_NUM_REQS_TO_START_PACK;
 
 	blk_queue_prep_rq(mq->queue, mmc_prep_request);
+	if (mmc_card_mmc(card) && (host->caps2 & MMC_CAP2_PACKED_WR))
+		blk_urgent_request(mq->queue, mmc_urgent_request);
 	queue_flag_set_unlocked(QUEUE_FLAG_NONROT, mq->queue);
 	if (mmc_can_erase(card))
 		mmc_queue_setup_discard(mq->queue, card);
@@ -452,6 +480,9 @@ static unsigned int mmc_queue_packed_map_sg(struct mmc_queue *mq,
 				sizeof(mqrq->packed_cmd_hdr));
 		sg_len++;
 		__sg->page_link &= ~0x02;
+	} else if (cmd == MMC_PACKED_READ) {
+		sg_init_one(&mqrq->packed_hdr_sg, mqrq->packed_cmd_hdr,
+				sizeof(mqrq->packed_cmd_hdr));
 	}
 
 	__sg = sg + sg_len;
@@ -26,6 +26,7 @@ enum mmc_blk_status {
 enum mmc_packed_cmd {
 	MMC_PACKED_NONE = 0,
 	MMC_PACKED_WRITE,
+	MMC_PACKED_READ,
 };
 
 struct mmc_queue_req {
@@ -38,10 +39,13 @@ struct mmc_queue_req {
 	struct mmc_async_req	mmc_active;
 	struct list_head	packed_list;
 	u32			packed_cmd_hdr[128];
+	struct mmc_blk_request	packed_hdr_brq;
+	struct scatterlist	packed_hdr_sg;
 	unsigned int		packed_blocks;
 	enum mmc_packed_cmd	packed_cmd;
 	int		packed_fail_idx;
 	u8		packed_num;
+	ktime_t		pack_stime;
 };
 
 struct mmc_queue {
@@ -58,6 +62,8 @@ struct mmc_queue {
 	bool			wr_packing_enabled;
 	int			num_of_potential_packed_wr_reqs;
 	int			num_wr_reqs_to_start_packing;
+	bool			urgent_pending;
+	ktime_t			urgent_stime;
 	int (*err_check_fn) (struct mmc_card *, struct mmc_async_req *);
 	void (*packed_test_fn) (struct request_queue *, struct mmc_queue_req *);
 };
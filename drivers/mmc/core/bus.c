@@ -246,6 +246,9 @@ struct mmc_card *mmc_alloc_card(struct mmc_host *host, struct device_type *type)
 	card->dev.type = type;
 
 	spin_lock_init(&card->wr_pack_stats.lock);
+	spin_lock_init(&card->rd_pack_stats.lock);
+	spin_lock_init(&card->urgent_stats.lock);
+	mmc_init_idle_time_bkops(card);
 
 	return card;
 }
@@ -357,7 +360,10 @@ void mmc_remove_card(struct mmc_card *card)
 		device_del(&card->dev);
 	}
 
+	mmc_stop_idle_time_bkops(card);
+
 	kfree(card->wr_pack_stats.packing_events);
+	kfree(card->rd_pack_stats.packing_events);
 
 	put_device(&card->dev);
 }
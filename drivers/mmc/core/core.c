@@ -46,6 +46,7 @@
 #include "sdio_ops.h"
 
 #define MMC_BKOPS_MAX_TIMEOUT    (4 * 60 * 1000) 
+#define MMC_IDLE_BKOPS_DELAY_MS  2000
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/mmcio.h>
@@ -606,6 +607,7 @@ void mmc_start_bkops(struct mmc_card *card)
 	spin_lock_irqsave(&card->host->lock, flags);
 
 	mmc_card_set_doing_bkops(card);
+	card->bkops_info.idle_started = false;
 	if (card->ext_csd.raw_bkops_status >= EXT_CSD_BKOPS_LEVEL_2) {
 		card->host->bkops_trigger = timeout;
 		if (card->need_sanitize)
@@ -613,11 +615,101 @@ void mmc_start_bkops(struct mmc_card *card)
 		mmc_card_set_need_bkops(card);
 	}
 	spin_unlock_irqrestore(&card->host->lock, flags);
+
+	spin_lock_irqsave(&card->bkops_info.stats.lock, flags);
+	card->bkops_info.stats.urgent_started++;
+	spin_unlock_irqrestore(&card->bkops_info.stats.lock, flags);
 out:
 	mmc_release_host(card->host);
 }
 EXPORT_SYMBOL(mmc_start_bkops);
 
+static void mmc_idle_time_bkops_work(struct work_struct *work)
+{
+	struct mmc_card *card = container_of(to_delayed_work(work),
+					     struct mmc_card, bkops_info.dw);
+	struct mmc_host *host = card->host;
+	struct mmc_bkops_stats *stats = &card->bkops_info.stats;
+	unsigned long flags;
+	int err;
+
+	mmc_claim_host(host);
+
+	if (mmc_card_doing_bkops(card) || mmc_card_doing_sanitize(card) ||
+	    mmc_card_removed(card))
+		goto out;
+
+	err = mmc_read_bkops_status(card);
+	if (err) {
+		pr_err("%s: %s: error %d reading bkops status\n",
+		       mmc_hostname(host), __func__, err);
+		goto out;
+	}
+
+	if (card->ext_csd.raw_bkops_status == EXT_CSD_BKOPS_LEVEL_0) {
+		spin_lock_irqsave(&stats->lock, flags);
+		stats->idle_skipped++;
+		spin_unlock_irqrestore(&stats->lock, flags);
+		goto out;
+	}
+
+	err = mmc_switch(card, EXT_CSD_CMD_SET_NORMAL,
+			EXT_CSD_BKOPS_START, 1, 0);
+	if (err) {
+		pr_warning("%s: error %d starting idle bkops\n",
+			   mmc_hostname(host), err);
+		goto out;
+	}
+
+	pr_debug("%s: %s, level %d\n", mmc_hostname(host), __func__,
+		 card->ext_csd.raw_bkops_status);
+
+	spin_lock_irqsave(&host->lock, flags);
+	mmc_card_set_doing_bkops(card);
+	card->bkops_info.idle_started = true;
+	spin_unlock_irqrestore(&host->lock, flags);
+
+	spin_lock_irqsave(&stats->lock, flags);
+	stats->idle_started++;
+	spin_unlock_irqrestore(&stats->lock, flags);
+out:
+	mmc_release_host(host);
+}
+
+void mmc_init_idle_time_bkops(struct mmc_card *card)
+{
+	INIT_DELAYED_WORK(&card->bkops_info.dw, mmc_idle_time_bkops_work);
+	card->bkops_info.delay_ms = MMC_IDLE_BKOPS_DELAY_MS;
+	spin_lock_init(&card->bkops_info.stats.lock);
+}
+EXPORT_SYMBOL(mmc_init_idle_time_bkops);
+
+void mmc_start_idle_time_bkops(struct mmc_card *card)
+{
+	if (!card->ext_csd.bkops_en || !card->ext_csd.hpi_en ||
+	    !(card->host->caps2 & MMC_CAP2_BKOPS))
+		return;
+
+	if (card->bkops_info.queued || mmc_card_doing_bkops(card) ||
+	    !card->bkops_info.delay_ms)
+		return;
+
+	card->bkops_info.queued = true;
+	queue_delayed_work(system_nrt_freezable_wq, &card->bkops_info.dw,
+			   msecs_to_jiffies(card->bkops_info.delay_ms));
+}
+EXPORT_SYMBOL(mmc_start_idle_time_bkops);
+
+void mmc_stop_idle_time_bkops(struct mmc_card *card)
+{
+	if (!card->bkops_info.queued)
+		return;
+
+	cancel_delayed_work_sync(&card->bkops_info.dw);
+	card->bkops_info.queued = false;
+}
+EXPORT_SYMBOL(mmc_stop_idle_time_bkops);
+
 static void mmc_wait_done(struct mmc_request *mrq)
 {
 	complete(&mrq->completion);
@@ -803,19 +895,39 @@ int mmc_wait_for_cmd(struct mmc_host *host, struct mmc_command *cmd, int retries
 
 EXPORT_SYMBOL(mmc_wait_for_cmd);
 
-int mmc_interrupt_bkops(struct mmc_card *card)
+static int __mmc_interrupt_bkops(struct mmc_card *card, bool for_io)
 {
+	struct mmc_bkops_stats *stats;
 	int err = 0;
 	unsigned long flags;
+	bool bkops;
+	ktime_t start;
+	u32 us;
 
 	BUG_ON(!card);
 
+	stats = &card->bkops_info.stats;
+	bkops = mmc_card_doing_bkops(card);
+	start = ktime_get();
+
 	err = mmc_interrupt_hpi(card);
 
 	spin_lock_irqsave(&card->host->lock, flags);
 	mmc_card_clr_doing_bkops(card);
 	mmc_card_clr_doing_sanitize(card);
+	card->bkops_info.idle_started = false;
 	spin_unlock_irqrestore(&card->host->lock, flags);
+
+	if (bkops) {
+		us = ktime_to_us(ktime_sub(ktime_get(), start));
+		spin_lock_irqsave(&stats->lock, flags);
+		if (for_io)
+			stats->interrupted++;
+		stats->hpi_us += us;
+		if (us > stats->hpi_max_us)
+			stats->hpi_max_us = us;
+		spin_unlock_irqrestore(&stats->lock, flags);
+	}
 	if (err)
 		pr_err("%s: send hpi fail : %d\n",
 		       mmc_hostname(card->host), err);
@@ -824,6 +936,16 @@ int mmc_interrupt_bkops(struct mmc_card *card)
 		       mmc_hostname(card->host), err);
 	return err;
 }
+
+/*
+ * Stop BKOPS or sanitize with HPI because a request is waiting. The
+ * suspend path calls __mmc_interrupt_bkops() directly so that only
+ * interruptions by i/o are counted in the stats.
+ */
+int mmc_interrupt_bkops(struct mmc_card *card)
+{
+	return __mmc_interrupt_bkops(card, true);
+}
 EXPORT_SYMBOL(mmc_interrupt_bkops);
 
 int mmc_read_bkops_status(struct mmc_card *card)
@@ -2567,6 +2689,13 @@ int mmc_suspend_host(struct mmc_host *host)
 	if (mmc_bus_needs_resume(host))
 		return 0;
 
+	if (host->card && mmc_card_mmc(host->card)) {
+		mmc_stop_idle_time_bkops(host->card);
+		if (host->card->bkops_info.idle_started &&
+		    mmc_card_doing_bkops(host->card))
+			__mmc_interrupt_bkops(host->card, false);
+	}
+
 	if (cancel_delayed_work(&host->detect))
 		wake_unlock(&host->detect_wake_lock);
 	mmc_flush_scheduled_work();
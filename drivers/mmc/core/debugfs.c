@@ -324,45 +324,46 @@ static int mmc_wr_pack_stats_open(struct inode *inode, struct file *filp)
 	return 0;
 }
 
+static int mmc_rd_pack_stats_open(struct inode *inode, struct file *filp)
+{
+	struct mmc_card *card = inode->i_private;
+
+	filp->private_data = card;
+	card->rd_pack_stats.print_in_read = 1;
+	return 0;
+}
+
 #define TEMP_BUF_SIZE 256
-static ssize_t mmc_wr_pack_stats_read(struct file *filp, char __user *ubuf,
-				size_t cnt, loff_t *ppos)
+static ssize_t mmc_pack_stats_read(struct mmc_card *card,
+				   struct mmc_wr_pack_stats *pack_stats,
+				   int max_num_of_packed_reqs, const char *dir,
+				   char __user *ubuf, size_t cnt)
 {
-	struct mmc_card *card = filp->private_data;
-	struct mmc_wr_pack_stats *pack_stats;
 	int i;
-	int max_num_of_packed_reqs = 0;
 	char *temp_buf;
 
-	if (!card)
-		return cnt;
-
-	if (!card->wr_pack_stats.print_in_read)
+	if (!pack_stats->print_in_read)
 		return 0;
 
-	if (!card->wr_pack_stats.enabled) {
-		pr_info("%s: write packing statistics are disabled\n",
-			 mmc_hostname(card->host));
+	if (!pack_stats->enabled) {
+		pr_info("%s: %s packing statistics are disabled\n",
+			 mmc_hostname(card->host), dir);
 		goto exit;
 	}
 
-	pack_stats = &card->wr_pack_stats;
-
 	if (!pack_stats->packing_events) {
 		pr_info("%s: NULL packing_events\n", mmc_hostname(card->host));
 		goto exit;
 	}
 
-	max_num_of_packed_reqs = card->ext_csd.max_packed_writes;
-
 	temp_buf = kmalloc(TEMP_BUF_SIZE, GFP_KERNEL);
 	if (!temp_buf)
 		goto exit;
 
 	spin_lock(&pack_stats->lock);
 
-	snprintf(temp_buf, TEMP_BUF_SIZE, "%s: write packing statistics:\n",
-		mmc_hostname(card->host));
+	snprintf(temp_buf, TEMP_BUF_SIZE, "%s: %s packing statistics:\n",
+		mmc_hostname(card->host), dir);
 	strlcat(ubuf, temp_buf, cnt);
 
 	for (i = 1 ; i <= max_num_of_packed_reqs ; ++i) {
@@ -437,14 +438,40 @@ static ssize_t mmc_wr_pack_stats_read(struct file *filp, char __user *ubuf,
 	pr_info("%s", ubuf);
 
 exit:
-	if (card->wr_pack_stats.print_in_read == 1) {
-		card->wr_pack_stats.print_in_read = 0;
+	if (pack_stats->print_in_read == 1) {
+		pack_stats->print_in_read = 0;
 		return strnlen(ubuf, cnt);
 	}
 
 	return 0;
 }
 
+static ssize_t mmc_wr_pack_stats_read(struct file *filp, char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	struct mmc_card *card = filp->private_data;
+
+	if (!card)
+		return cnt;
+
+	return mmc_pack_stats_read(card, &card->wr_pack_stats,
+				   card->ext_csd.max_packed_writes, "write",
+				   ubuf, cnt);
+}
+
+static ssize_t mmc_rd_pack_stats_read(struct file *filp, char __user *ubuf,
+				size_t cnt, loff_t *ppos)
+{
+	struct mmc_card *card = filp->private_data;
+
+	if (!card)
+		return cnt;
+
+	return mmc_pack_stats_read(card, &card->rd_pack_stats,
+				   card->ext_csd.max_packed_reads, "read",
+				   ubuf, cnt);
+}
+
 static ssize_t mmc_wr_pack_stats_write(struct file *filp,
 				       const char __user *ubuf, size_t cnt,
 				       loff_t *ppos)
@@ -473,6 +500,133 @@ static const struct file_operations mmc_dbg_wr_pack_stats_fops = {
 	.write		= mmc_wr_pack_stats_write,
 };
 
+static ssize_t mmc_rd_pack_stats_write(struct file *filp,
+				       const char __user *ubuf, size_t cnt,
+				       loff_t *ppos)
+{
+	struct mmc_card *card = filp->private_data;
+	int value;
+
+	if (!card)
+		return cnt;
+
+	sscanf(ubuf, "%d", &value);
+	if (value) {
+		mmc_blk_init_rd_packed_statistics(card);
+	} else {
+		spin_lock(&card->rd_pack_stats.lock);
+		card->rd_pack_stats.enabled = false;
+		spin_unlock(&card->rd_pack_stats.lock);
+	}
+
+	return cnt;
+}
+
+static const struct file_operations mmc_dbg_rd_pack_stats_fops = {
+	.open		= mmc_rd_pack_stats_open,
+	.read		= mmc_rd_pack_stats_read,
+	.write		= mmc_rd_pack_stats_write,
+};
+
+static int mmc_urgent_stats_show(struct seq_file *s, void *data)
+{
+	struct mmc_card *card = s->private;
+	struct mmc_urgent_stats stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&card->urgent_stats.lock, flags);
+	stats = card->urgent_stats;
+	spin_unlock_irqrestore(&card->urgent_stats.lock, flags);
+
+	seq_printf(s, "notified:\t\t%u\n", stats.notified);
+	seq_printf(s, "issued:\t\t\t%u\n", stats.issued);
+	seq_printf(s, "wait total:\t\t%llu us\n", stats.wait_us);
+	seq_printf(s, "wait max:\t\t%u us\n", stats.max_wait_us);
+	seq_printf(s, "packing stopped:\t%u\n", stats.pack_stopped);
+	seq_printf(s, "preempted packs:\t%u\n", stats.preempted_packs);
+	seq_printf(s, "preempted reqs:\t\t%u\n", stats.preempted_reqs);
+	seq_printf(s, "preempted sectors:\t%llu\n", stats.preempted_sectors);
+	seq_printf(s, "latency saved:\t\t%llu us\n", stats.saved_us);
+
+	return 0;
+}
+
+static int mmc_urgent_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mmc_urgent_stats_show, inode->i_private);
+}
+
+static ssize_t mmc_urgent_stats_write(struct file *filp,
+				      const char __user *ubuf, size_t cnt,
+				      loff_t *ppos)
+{
+	struct mmc_card *card = ((struct seq_file *)filp->private_data)->private;
+	struct mmc_urgent_stats *stats = &card->urgent_stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	memset(stats, 0, offsetof(struct mmc_urgent_stats, lock));
+	spin_unlock_irqrestore(&stats->lock, flags);
+
+	return cnt;
+}
+
+static const struct file_operations mmc_dbg_urgent_stats_fops = {
+	.open		= mmc_urgent_stats_open,
+	.read		= seq_read,
+	.write		= mmc_urgent_stats_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int mmc_bkops_stats_show(struct seq_file *s, void *data)
+{
+	struct mmc_card *card = s->private;
+	struct mmc_bkops_stats stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&card->bkops_info.stats.lock, flags);
+	stats = card->bkops_info.stats;
+	spin_unlock_irqrestore(&card->bkops_info.stats.lock, flags);
+
+	seq_printf(s, "idle started:\t\t%u\n", stats.idle_started);
+	seq_printf(s, "idle not needed:\t%u\n", stats.idle_skipped);
+	seq_printf(s, "urgent started:\t\t%u\n", stats.urgent_started);
+	seq_printf(s, "interrupted by i/o:\t%u\n", stats.interrupted);
+	seq_printf(s, "hpi total:\t\t%llu us\n", stats.hpi_us);
+	seq_printf(s, "hpi max:\t\t%u us\n", stats.hpi_max_us);
+
+	return 0;
+}
+
+static int mmc_bkops_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mmc_bkops_stats_show, inode->i_private);
+}
+
+static ssize_t mmc_bkops_stats_write(struct file *filp,
+				     const char __user *ubuf, size_t cnt,
+				     loff_t *ppos)
+{
+	struct mmc_card *card = ((struct seq_file *)filp->private_data)->private;
+	struct mmc_bkops_stats *stats = &card->bkops_info.stats;
+	unsigned long flags;
+
+	spin_lock_irqsave(&stats->lock, flags);
+	memset(stats, 0, offsetof(struct mmc_bkops_stats, lock));
+	spin_unlock_irqrestore(&stats->lock, flags);
+
+	return cnt;
+}
+
+static const struct file_operations mmc_dbg_bkops_stats_fops = {
+	.open		= mmc_bkops_stats_open,
+	.read		= seq_read,
+	.write		= mmc_bkops_stats_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 void mmc_add_card_debugfs(struct mmc_card *card)
 {
 	struct mmc_host	*host = card->host;
@@ -509,6 +663,26 @@ void mmc_add_card_debugfs(struct mmc_card *card)
 					 &mmc_dbg_wr_pack_stats_fops))
 			goto err;
 
+	if (mmc_card_mmc(card) && (card->ext_csd.rev >= 6) &&
+	    (card->host->caps2 & MMC_CAP2_PACKED_RD))
+		if (!debugfs_create_file("rd_pack_stats", S_IRUSR, root, card,
+					 &mmc_dbg_rd_pack_stats_fops))
+			goto err;
+
+	if (mmc_card_mmc(card) && (card->host->caps2 & MMC_CAP2_PACKED_WR))
+		if (!debugfs_create_file("urgent_stats", S_IRUSR | S_IWUSR,
+					 root, card, &mmc_dbg_urgent_stats_fops))
+			goto err;
+
+	if (mmc_card_mmc(card) && (card->host->caps2 & MMC_CAP2_BKOPS)) {
+		if (!debugfs_create_file("bkops_stats", S_IRUSR | S_IWUSR,
+					 root, card, &mmc_dbg_bkops_stats_fops))
+			goto err;
+		if (!debugfs_create_u32("bkops_idle_delay_ms", S_IRUSR | S_IWUSR,
+					root, &card->bkops_info.delay_ms))
+			goto err;
+	}
+
 	return;
 
 err:
@@ -1270,6 +1270,15 @@ do_retry:
 			if (!card->wr_pack_stats.packing_events)
 				goto free_card;
 		}
+		if ((host->caps2 & MMC_CAP2_PACKED_RD) &&
+		    (card->ext_csd.max_packed_reads > 0)) {
+			card->rd_pack_stats.packing_events = kzalloc(
+				(card->ext_csd.max_packed_reads + 1) *
+				sizeof(*card->rd_pack_stats.packing_events),
+				GFP_KERNEL);
+			if (!card->rd_pack_stats.packing_events)
+				goto free_card;
+		}
 	}
 
 	if (!oldcard)
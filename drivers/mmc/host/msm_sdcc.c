@@ -5768,6 +5768,7 @@ msmsdcc_probe(struct platform_device *pdev)
 	if (plat->pack_cmd_support) {
 		mmc->caps2 |= MMC_CAP2_PACKED_WR;
 		mmc->caps2 |= MMC_CAP2_PACKED_WR_CONTROL;
+		mmc->caps2 |= MMC_CAP2_PACKED_RD;
 	}
 
 	if (is_sd_platform(host->plat))
@@ -67,6 +67,8 @@ module_param_named(debug_enable, msm_rmnet_bam_debug_mask,
 #define HEADROOM_FOR_QOS    8
 #define TAILROOM            8 
 
+#define RMNET_NAPI_WEIGHT   64
+
 struct rmnet_private {
 	struct net_device_stats stats;
 	uint32_t ch_id;
@@ -83,8 +85,22 @@ struct rmnet_private {
 	u32 operation_mode; 
 	uint8_t device_up;
 	uint8_t in_reset;
+	struct napi_struct napi;
+	struct sk_buff_head rx_queue;
+	unsigned long rx_napi_polls;
+	unsigned long rx_budget_exhausted;
+	unsigned long rx_batches_polled;
+	unsigned long rx_batches_irq;
+	u8 bql_gen;
+};
+
+struct rmnet_bql_cb {
+	u32 len;
+	u8 gen;
 };
 
+#define RMNET_BQL_CB(skb) ((struct rmnet_bql_cb *)(skb)->cb)
+
 #ifdef CONFIG_MSM_RMNET_DEBUG
 static unsigned long timeout_us;
 
@@ -199,6 +215,20 @@ static ssize_t timeout_show(struct device *d, struct device_attribute *attr,
 DEVICE_ATTR(timeout, 0664, timeout_show, timeout_store);
 #endif
 
+static ssize_t rx_napi_stats_show(struct device *d,
+				  struct device_attribute *attr, char *buf)
+{
+	struct rmnet_private *p = netdev_priv(to_net_dev(d));
+
+	return sprintf(buf, "polls=%lu budget_exhausted=%lu "
+		       "batches_polled=%lu batches_irq=%lu backlog=%u\n",
+		       p->rx_napi_polls, p->rx_budget_exhausted,
+		       p->rx_batches_polled, p->rx_batches_irq,
+		       skb_queue_len(&p->rx_queue));
+}
+
+static DEVICE_ATTR(rx_napi_stats, 0444, rx_napi_stats_show, NULL);
+
 static int rmnet_ioctl(struct net_device *dev, struct ifreq *ifr, int cmd);
 
 static __be16 rmnet_ip_type_trans(struct sk_buff *skb, struct net_device *dev)
@@ -249,6 +279,7 @@ static void bam_recv_notify(void *dev, struct sk_buff *skb)
 		if (RMNET_IS_MODE_IP(opmode)) {
 			
 			skb->protocol = rmnet_ip_type_trans(skb, dev);
+			skb_reset_mac_header(skb);
 		} else {
 			
 			skb->protocol = eth_type_trans(skb, dev);
@@ -265,13 +296,80 @@ static void bam_recv_notify(void *dev, struct sk_buff *skb)
 			((struct net_device *)dev)->name,
 			p->stats.rx_packets, skb->len);
 
-		
-		netif_rx(skb);
+		if (!netif_running(dev)) {
+			netif_rx(skb);
+			return;
+		}
+
+		if (skb_queue_len(&p->rx_queue) >= netdev_max_backlog) {
+			p->stats.rx_dropped++;
+			dev_kfree_skb_any(skb);
+			return;
+		}
+
+		skb_queue_tail(&p->rx_queue, skb);
+		if (napi_schedule_prep(&p->napi)) {
+			if (msm_bam_dmux_is_polling())
+				p->rx_batches_polled++;
+			else
+				p->rx_batches_irq++;
+			__napi_schedule(&p->napi);
+		}
 	} else
 		pr_err(MODULE_NAME "[%s] %s: No skb received",
 			((struct net_device *)dev)->name, __func__);
 }
 
+static int rmnet_poll(struct napi_struct *napi, int budget)
+{
+	struct rmnet_private *p = container_of(napi, struct rmnet_private,
+					       napi);
+	struct sk_buff *skb;
+	int work = 0;
+
+	p->rx_napi_polls++;
+
+	while (work < budget) {
+		skb = skb_dequeue(&p->rx_queue);
+		if (!skb)
+			break;
+		napi_gro_receive(napi, skb);
+		work++;
+	}
+
+	if (work < budget) {
+		napi_complete(napi);
+		if (!skb_queue_empty(&p->rx_queue) &&
+		    napi_schedule_prep(napi))
+			__napi_schedule(napi);
+	} else
+		p->rx_budget_exhausted++;
+
+	return work;
+}
+
+static void rmnet_bql_completed(struct net_device *dev, u8 gen, u32 len)
+{
+	struct rmnet_private *p = netdev_priv(dev);
+	unsigned long flags;
+
+	spin_lock_irqsave(&p->tx_queue_lock, flags);
+	if (gen == p->bql_gen)
+		netdev_completed_queue(dev, 1, len);
+	spin_unlock_irqrestore(&p->tx_queue_lock, flags);
+}
+
+static void rmnet_bql_reset(struct net_device *dev)
+{
+	struct rmnet_private *p = netdev_priv(dev);
+	unsigned long flags;
+
+	spin_lock_irqsave(&p->tx_queue_lock, flags);
+	p->bql_gen++;
+	netdev_reset_queue(dev);
+	spin_unlock_irqrestore(&p->tx_queue_lock, flags);
+}
+
 static int _rmnet_xmit(struct sk_buff *skb, struct net_device *dev)
 {
 	struct rmnet_private *p = netdev_priv(dev);
@@ -279,6 +377,8 @@ static int _rmnet_xmit(struct sk_buff *skb, struct net_device *dev)
 	struct QMI_QOS_HDR_S *qmih;
 	u32 opmode;
 	unsigned long flags;
+	u32 len;
+	u8 gen;
 
 	
 	spin_lock_irqsave(&p->lock, flags);
@@ -294,8 +394,16 @@ static int _rmnet_xmit(struct sk_buff *skb, struct net_device *dev)
 	}
 
 	dev->trans_start = jiffies;
-	
+
+	len = skb->len;
+	gen = p->bql_gen;
+	RMNET_BQL_CB(skb)->len = len;
+	RMNET_BQL_CB(skb)->gen = gen;
+	netdev_sent_queue(dev, len);
+
 	bam_ret = msm_bam_dmux_write(p->ch_id, skb);
+	if (bam_ret)
+		rmnet_bql_completed(dev, gen, len);
 
 	if (bam_ret != 0 && bam_ret != -EAGAIN && bam_ret != -EFAULT) {
 		pr_err(MODULE_NAME "[%s] %s: write returned error %d",
@@ -324,6 +432,8 @@ static void bam_write_done(void *dev, struct sk_buff *skb)
 	DBG1("[%s] Tx packet #%lu len=%d mark=0x%x\n",
 	    ((struct net_device *)(dev))->name, p->stats.tx_packets,
 	    skb->len, skb->mark);
+	rmnet_bql_completed(dev, RMNET_BQL_CB(skb)->gen,
+			    RMNET_BQL_CB(skb)->len);
 	dev_kfree_skb_any(skb);
 
 	spin_lock_irqsave(&p->tx_queue_lock, flags);
@@ -396,14 +506,20 @@ static int __rmnet_open(struct net_device *dev)
 
 static int rmnet_open(struct net_device *dev)
 {
+	struct rmnet_private *p = netdev_priv(dev);
 	int rc = 0;
 
 	DBG0("[%s] rmnet_open()\n", dev->name);
 
 	rc = __rmnet_open(dev);
 
-	if (rc == 0)
+	if (rc == 0) {
+		napi_enable(&p->napi);
+		if (!skb_queue_empty(&p->rx_queue))
+			napi_schedule(&p->napi);
+		rmnet_bql_reset(dev);
 		netif_start_queue(dev);
+	}
 
 	return rc;
 }
@@ -426,10 +542,14 @@ static int __rmnet_close(struct net_device *dev)
 
 static int rmnet_stop(struct net_device *dev)
 {
+	struct rmnet_private *p = netdev_priv(dev);
+
 	DBG0("[%s] rmnet_stop()\n", dev->name);
 
 	__rmnet_close(dev);
 	netif_stop_queue(dev);
+	napi_disable(&p->napi);
+	skb_queue_purge(&p->rx_queue);
 
 	return 0;
 }
@@ -690,6 +810,7 @@ static int bam_rmnet_probe(struct platform_device *pdev)
 		p->in_reset = 0;
 		msm_bam_dmux_open(p->ch_id, netdevs[i], bam_notify);
 		netif_carrier_on(netdevs[i]);
+		rmnet_bql_reset(netdevs[i]);
 		netif_start_queue(netdevs[i]);
 	}
 
@@ -767,6 +888,8 @@ static int __init rmnet_init(void)
 		p->in_reset = 0;
 		spin_lock_init(&p->lock);
 		spin_lock_init(&p->tx_queue_lock);
+		skb_queue_head_init(&p->rx_queue);
+		netif_napi_add(dev, &p->napi, rmnet_poll, RMNET_NAPI_WEIGHT);
 #ifdef CONFIG_MSM_RMNET_DEBUG
 		p->timeout_us = timeout_us;
 		p->wakeups_xmit = p->wakeups_rcv = 0;
@@ -780,6 +903,10 @@ static int __init rmnet_init(void)
 			return ret;
 		}
 
+		if (device_create_file(d, &dev_attr_rx_napi_stats))
+			pr_err(MODULE_NAME "%s: unable to create rx_napi_stats"
+				   " for netdev %d\n", __func__, n);
+
 #ifdef CONFIG_MSM_RMNET_DEBUG
 		if (device_create_file(d, &dev_attr_timeout))
 			continue;
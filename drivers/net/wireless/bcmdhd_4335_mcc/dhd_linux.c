@@ -295,6 +295,9 @@ typedef struct dhd_if {
 	struct list_head ipv6_list;
 	spinlock_t		ipv6_lock;
 	bool			event2cfg80211;	
+#ifdef DHD_BQL
+	uint8			bql_gen;
+#endif
 } dhd_if_t;
 
 #ifdef WLMEDIA_HTSF
@@ -417,6 +420,9 @@ bool dhd_force_exit;
 #ifdef DHDTCPACK_SUPPRESS
 	spinlock_t	tcpack_lock;
 #endif 
+#ifdef DHD_BQL
+	spinlock_t	bql_lock;
+#endif
 } dhd_info_t;
 
 uint dhd_download_fw_on_driverload = TRUE;
@@ -1572,6 +1578,87 @@ dhd_sendpkt(dhd_pub_t *dhdp, int ifidx, void *pktbuf)
 	return ret;
 }
 
+#ifdef DHD_BQL
+#define DHD_BQL_MAGIC	0xb91e
+
+typedef struct dhd_bql_tag {
+	uint16	magic;
+	uint8	ifidx;
+	uint8	gen;
+	uint32	len;
+} dhd_bql_tag_t;
+
+#define DHD_BQL_TAG(skb) \
+	((dhd_bql_tag_t *)&((struct sk_buff *)(skb))->cb[OSL_PKTTAG_SZ])
+
+static void
+dhd_bql_sent(dhd_info_t *dhd, int ifidx, struct sk_buff *skb)
+{
+	dhd_if_t *ifp = dhd->iflist[ifidx];
+	dhd_bql_tag_t *tag = DHD_BQL_TAG(skb);
+
+	tag->magic = DHD_BQL_MAGIC;
+	tag->ifidx = ifidx;
+	tag->gen = ifp->bql_gen;
+	tag->len = skb->len;
+	netdev_sent_queue(ifp->net, skb->len);
+}
+
+static void
+dhd_bql_pktfree(void *ctx, void *pkt, unsigned int status)
+{
+	dhd_info_t *dhd = (dhd_info_t *)ctx;
+	struct sk_buff *skb;
+	dhd_bql_tag_t *tag;
+	dhd_if_t *ifp;
+	unsigned long flags;
+	uint32 len;
+#ifdef CONFIG_BQL
+	struct dql *dql;
+#endif
+
+	spin_lock_irqsave(&dhd->bql_lock, flags);
+	for (skb = (struct sk_buff *)pkt; skb; skb = skb->next) {
+		tag = DHD_BQL_TAG(skb);
+		if (tag->magic != DHD_BQL_MAGIC)
+			continue;
+		tag->magic = 0;
+
+		if (tag->ifidx >= DHD_MAX_IFS)
+			continue;
+		ifp = dhd->iflist[tag->ifidx];
+		if (!ifp || !ifp->net || ifp->bql_gen != tag->gen)
+			continue;
+
+		len = tag->len;
+#ifdef CONFIG_BQL
+		dql = &netdev_get_tx_queue(ifp->net, 0)->dql;
+		len = min(len, dql->num_queued - dql->num_completed);
+#endif
+		netdev_completed_queue(ifp->net, 1, len);
+	}
+	spin_unlock_irqrestore(&dhd->bql_lock, flags);
+}
+
+static void
+dhd_bql_reset(dhd_info_t *dhd, int ifidx)
+{
+	dhd_if_t *ifp;
+	unsigned long flags;
+
+	if (ifidx < 0 || ifidx >= DHD_MAX_IFS)
+		return;
+	ifp = dhd->iflist[ifidx];
+	if (!ifp || !ifp->net)
+		return;
+
+	spin_lock_irqsave(&dhd->bql_lock, flags);
+	ifp->bql_gen++;
+	netdev_reset_queue(ifp->net);
+	spin_unlock_irqrestore(&dhd->bql_lock, flags);
+}
+#endif 
+
 int
 dhd_start_xmit(struct sk_buff *skb, struct net_device *net)
 {
@@ -1668,6 +1755,9 @@ if (dhd->pub.busstate == DHD_BUS_DOWN || dhd->pub.hang_was_sent || dhd->pub.os_s
 	}
 #endif
 
+#ifdef DHD_BQL
+	dhd_bql_sent(dhd, ifidx, skb);
+#endif
 	ret = dhd_sendpkt(&dhd->pub, ifidx, pktbuf);
 
 #ifdef CUSTOMER_HW_ONE
@@ -2978,6 +3068,9 @@ dhd_stop(struct net_device *net)
 	
 	netif_stop_queue(net);
 	dhd->pub.up = 0;
+#ifdef DHD_BQL
+	dhd_bql_reset(dhd, ifidx);
+#endif
 
 #ifdef WL_CFG80211
 	if (ifidx == 0) {
@@ -3142,6 +3235,9 @@ dhd_open_retry:
 	}
 
 	
+#ifdef DHD_BQL
+	dhd_bql_reset(dhd, ifidx);
+#endif
 	netif_start_queue(net);
 	dhd->pub.up = 1;
 
@@ -3529,6 +3625,10 @@ dhd_attach(osl_t *osh, struct dhd_bus *bus, uint bus_hdrlen)
 #ifdef DHDTCPACK_SUPPRESS
 	spin_lock_init(&dhd->tcpack_lock);
 #endif 
+#ifdef DHD_BQL
+	spin_lock_init(&dhd->bql_lock);
+	PKTFREESETCB(osh, dhd_bql_pktfree, dhd);
+#endif
 
 	
 	spin_lock_init(&dhd->wakelock_spinlock);
@@ -5049,6 +5149,9 @@ void dhd_detach(dhd_pub_t *dhdp)
 	dhd->dhd_force_exit = TRUE; 
 #endif
 	dhd->pub.up = 0;
+#ifdef DHD_BQL
+	PKTFREESETCB(dhdp->osh, NULL, NULL);
+#endif
 	if (!(dhd->dhd_state & DHD_ATTACH_STATE_DONE)) {
 		OSL_SLEEP(100);
 	}
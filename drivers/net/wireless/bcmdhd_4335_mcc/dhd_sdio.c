@@ -120,6 +120,10 @@ extern volatile bool dhd_mmc_suspend;
 
 #define DHD_TXMINMAX	1	
 
+#define DHD_ADAPT_INTERVAL_MS	1000
+#define DHD_ADAPT_MAX_LEVEL	2
+#define DHD_ADAPT_DOWN_INTERVALS	2
+
 #define MEMBLOCK	2048		
 #define MAX_NVRAMBUF_SIZE	4096	
 #define MAX_DATA_BUF	(32 * 1024)	
@@ -218,6 +222,15 @@ typedef struct dhd_console {
 #define OVERFLOW_BLKSZ512_MES		80
 
 #define CC_PMUCC3	(0x3)
+typedef struct dhd_adapt_stats {
+	uint32		bytes;			
+	uint		sdxfers;		
+	uint		rxglomframes;		
+	uint		rxglompkts;		
+	uint		txglomframes;		
+	uint		txglompkts;		
+} dhd_adapt_stats_t;
+
 typedef struct dhd_bus {
 	dhd_pub_t	*dhd;
 
@@ -358,6 +371,18 @@ typedef struct dhd_bus {
 	uint		f2rxdata;		
 	uint		f2txdata;		
 	uint		f1regdata;		
+	uint		txglomframes;		
+	uint		txglompkts;		
+
+	uint8		adapt_level;		
+	uint8		adapt_lowcnt;		
+	uint		adapt_base_glom;	
+	uint		adapt_base_rxbound;	
+	uint		adapt_base_txbound;	
+	uint32		adapt_start;		
+	dhd_adapt_stats_t	adapt_snap;	
+	dhd_adapt_stats_t	adapt_intv;	
+	uint32		adapt_intv_ms;		
 
 	uint8		*ctrl_frame_buf;
 	uint32		ctrl_frame_len;
@@ -416,6 +441,15 @@ uint dhd_dpcpoll = FALSE;
 module_param(dhd_doflow, uint, 0644);
 module_param(dhd_dpcpoll, uint, 0644);
 
+uint dhd_adapt_bound = TRUE;
+uint dhd_adapt_hi_kbps = 80000;
+uint dhd_adapt_lo_kbps = 20000;
+uint dhd_adapt_hi_xfers = 8000;
+module_param(dhd_adapt_bound, uint, 0644);
+module_param(dhd_adapt_hi_kbps, uint, 0644);
+module_param(dhd_adapt_lo_kbps, uint, 0644);
+module_param(dhd_adapt_hi_xfers, uint, 0644);
+
 static bool dhd_alignctl;
 
 static bool sd1idle;
@@ -575,6 +609,8 @@ static int dhdsdio_download_code_array(dhd_bus_t *bus);
 static int dhdsdio_bussleep(dhd_bus_t *bus, bool sleep);
 static int dhdsdio_clkctl(dhd_bus_t *bus, uint target, bool pendok);
 static uint8 dhdsdio_sleepcsr_get(dhd_bus_t *bus);
+static void dhdsdio_adapt_snapshot(dhd_bus_t *bus, dhd_adapt_stats_t *st);
+static void dhdsdio_adapt_reset(dhd_bus_t *bus);
 
 #ifdef WLMEDIA_HTSF
 #include <htsf.h>
@@ -2320,6 +2356,8 @@ dhdsdio_sendfromq(dhd_bus_t *bus, uint maxframes)
 				if (ret == BCME_OK)
 					datalen += datalen_tmp;
 			}
+			bus->txglomframes++;
+			bus->txglompkts += i;
 			cnt += i-1;
 		} else
 #endif 
@@ -2781,7 +2819,8 @@ enum {
 #endif
 	IOV_TXGLOMSIZE,
 	IOV_TXGLOMMODE,
-	IOV_HANGREPORT
+	IOV_HANGREPORT,
+	IOV_ADAPTBOUND
 };
 
 const bcm_iovar_t dhdsdio_iovars[] = {
@@ -2835,6 +2874,7 @@ const bcm_iovar_t dhdsdio_iovars[] = {
 	{"txglomsize", IOV_TXGLOMSIZE, 0, IOVT_UINT32, 0 },
 	{"txglommode", IOV_TXGLOMMODE, 0, IOVT_UINT32, 0 },
 	{"fw_hang_report", IOV_HANGREPORT, 0, IOVT_BOOL, 0 },
+	{"adaptbound", IOV_ADAPTBOUND, 0, IOVT_BOOL, 0 },
 	{NULL, 0, 0, 0, 0 }
 };
 
@@ -2881,6 +2921,30 @@ dhd_bus_dump(dhd_pub_t *dhdp, struct bcmstrbuf *strbuf)
 	bcm_bprintf(strbuf, "f2rx (hdrs/data) %u (%u/%u), f2tx %u f1regs %u\n",
 	            (bus->f2rxhdrs + bus->f2rxdata), bus->f2rxhdrs, bus->f2rxdata,
 	            bus->f2txdata, bus->f1regdata);
+	bcm_bprintf(strbuf, "txglomframes %u, txglompkts %u\n",
+	            bus->txglomframes, bus->txglompkts);
+	bcm_bprintf(strbuf, "adaptbound %u level %u glomsize %u rxbound %u txbound %u\n",
+	            dhd_adapt_bound, bus->adapt_level,
+#ifdef BCMSDIOH_TXGLOM
+	            bus->glomsize,
+#else
+	            0,
+#endif
+	            dhd_rxbound, dhd_txbound);
+	{
+		uint kb = bus->adapt_intv.bytes >> 10;
+
+		bcm_bprintf(strbuf, "last %u ms: %u kbps, sd xfers %u",
+		            bus->adapt_intv_ms, bus->adapt_intv_ms ?
+		            (uint)(((uint64)bus->adapt_intv.bytes * 8) / bus->adapt_intv_ms) : 0,
+		            bus->adapt_intv.sdxfers);
+		dhd_dump_pct(strbuf, ", sd xfers/MB", bus->adapt_intv.sdxfers * 1024, kb);
+		dhd_dump_pct(strbuf, "\n  Rx: pkts/glom", bus->adapt_intv.rxglompkts,
+		             bus->adapt_intv.rxglomframes);
+		dhd_dump_pct(strbuf, ", Tx: pkts/glom", bus->adapt_intv.txglompkts,
+		             bus->adapt_intv.txglomframes);
+		bcm_bprintf(strbuf, "\n");
+	}
 	{
 		dhd_dump_pct(strbuf, "\nRx: pkts/f2rd", bus->dhd->rx_packets,
 		             (bus->f2rxhdrs + bus->f2rxdata));
@@ -2895,6 +2959,9 @@ dhd_bus_dump(dhd_pub_t *dhdp, struct bcmstrbuf *strbuf)
 		dhd_dump_pct(strbuf, ", pkts/glom", bus->rxglompkts, bus->rxglomframes);
 		bcm_bprintf(strbuf, "\n");
 
+		dhd_dump_pct(strbuf, "Tx: pkts/glom", bus->txglompkts, bus->txglomframes);
+		bcm_bprintf(strbuf, "\n");
+
 		dhd_dump_pct(strbuf, "Tx: pkts/f2wr", bus->dhd->tx_packets, bus->f2txdata);
 		dhd_dump_pct(strbuf, ", pkts/f1sd", bus->dhd->tx_packets, bus->f1regdata);
 		dhd_dump_pct(strbuf, ", pkts/sd", bus->dhd->tx_packets,
@@ -2945,6 +3012,9 @@ dhd_bus_clearcounts(dhd_pub_t *dhdp)
 	bus->tx_sderrs = bus->fc_rcvd = bus->fc_xoff = bus->fc_xon = 0;
 	bus->rxglomfail = bus->rxglomframes = bus->rxglompkts = 0;
 	bus->f2rxhdrs = bus->f2rxdata = bus->f2txdata = bus->f1regdata = 0;
+	bus->txglomframes = bus->txglompkts = 0;
+	dhdsdio_adapt_snapshot(bus, &bus->adapt_snap);
+	bus->adapt_start = OSL_SYSUPTIME();
 }
 
 #ifdef SDTEST
@@ -3870,6 +3940,9 @@ dhdsdio_doiovar(dhd_bus_t *bus, const bcm_iovar_t *vi, uint32 actionid, const ch
 
 	case IOV_SVAL(IOV_TXBOUND):
 		dhd_txbound = (uint)int_val;
+		bus->adapt_base_txbound = dhd_txbound;
+		if (bus->adapt_level)
+			dhdsdio_adapt_apply(bus, bus->adapt_level);
 		break;
 
 	case IOV_GVAL(IOV_RXBOUND):
@@ -3879,6 +3952,9 @@ dhdsdio_doiovar(dhd_bus_t *bus, const bcm_iovar_t *vi, uint32 actionid, const ch
 
 	case IOV_SVAL(IOV_RXBOUND):
 		dhd_rxbound = (uint)int_val;
+		bus->adapt_base_rxbound = dhd_rxbound;
+		if (bus->adapt_level)
+			dhdsdio_adapt_apply(bus, bus->adapt_level);
 		break;
 
 	case IOV_GVAL(IOV_TXMINMAX):
@@ -4048,6 +4124,9 @@ dhdsdio_doiovar(dhd_bus_t *bus, const bcm_iovar_t *vi, uint32 actionid, const ch
 			bcmerror = BCME_ERROR;
 		} else {
 			bus->glomsize = (uint)int_val;
+			bus->adapt_base_glom = bus->glomsize;
+			if (bus->adapt_level)
+				dhdsdio_adapt_apply(bus, bus->adapt_level);
 		}
 		break;
 	case IOV_GVAL(IOV_TXGLOMMODE):
@@ -4073,6 +4152,17 @@ dhdsdio_doiovar(dhd_bus_t *bus, const bcm_iovar_t *vi, uint32 actionid, const ch
 		int_val = (int32)bus->dhd->hang_report;
 		bcopy(&int_val, arg, val_size);
 		break;
+
+	case IOV_GVAL(IOV_ADAPTBOUND):
+		int_val = (int32)dhd_adapt_bound;
+		bcopy(&int_val, arg, val_size);
+		break;
+
+	case IOV_SVAL(IOV_ADAPTBOUND):
+		if (!bool_val)
+			dhdsdio_adapt_reset(bus);
+		dhd_adapt_bound = bool_val;
+		break;
 	default:
 		bcmerror = BCME_UNSUPPORTED;
 		break;
@@ -6723,6 +6813,101 @@ dhd_disable_intr(dhd_pub_t *dhdp)
 	bcmsdh_intr_disable(bus->sdh);
 }
 
+static void
+dhdsdio_adapt_snapshot(dhd_bus_t *bus, dhd_adapt_stats_t *st)
+{
+	st->bytes = (uint32)(bus->dhd->dstats.rx_bytes + bus->dhd->dstats.tx_bytes);
+	st->sdxfers = bus->f2rxhdrs + bus->f2rxdata + bus->f2txdata + bus->f1regdata;
+	st->rxglomframes = bus->rxglomframes;
+	st->rxglompkts = bus->rxglompkts;
+	st->txglomframes = bus->txglomframes;
+	st->txglompkts = bus->txglompkts;
+}
+
+static void
+dhdsdio_adapt_apply(dhd_bus_t *bus, uint level)
+{
+	if (bus->adapt_level == 0 && level > 0) {
+#ifdef BCMSDIOH_TXGLOM
+		bus->adapt_base_glom = bus->glomsize;
+#endif
+		bus->adapt_base_rxbound = dhd_rxbound;
+		bus->adapt_base_txbound = dhd_txbound;
+	}
+
+#ifdef BCMSDIOH_TXGLOM
+	if (bus->adapt_base_glom)
+		bus->glomsize = bus->adapt_base_glom +
+			((SDPCM_MAXGLOM_SIZE - MIN(bus->adapt_base_glom,
+			SDPCM_MAXGLOM_SIZE)) * level) / DHD_ADAPT_MAX_LEVEL;
+#endif
+	dhd_rxbound = bus->adapt_base_rxbound << level;
+	dhd_txbound = bus->adapt_base_txbound << level;
+
+	DHD_INFO(("%s: level %u -> %u rxbound %u txbound %u\n", __FUNCTION__,
+	          bus->adapt_level, level, dhd_rxbound, dhd_txbound));
+	bus->adapt_level = (uint8)level;
+}
+
+static void
+dhdsdio_adapt_reset(dhd_bus_t *bus)
+{
+	if (bus->adapt_level)
+		dhdsdio_adapt_apply(bus, 0);
+	bus->adapt_lowcnt = 0;
+}
+
+static void
+dhdsdio_adapt_bounds(dhd_bus_t *bus)
+{
+	dhd_adapt_stats_t now;
+	uint32 msec, kbps, xfers;
+	uint level = bus->adapt_level;
+
+	if (!bus->adapt_start) {
+		dhdsdio_adapt_snapshot(bus, &bus->adapt_snap);
+		bus->adapt_start = OSL_SYSUPTIME();
+		return;
+	}
+
+	msec = OSL_SYSUPTIME() - bus->adapt_start;
+	if (msec < DHD_ADAPT_INTERVAL_MS)
+		return;
+
+	dhdsdio_adapt_snapshot(bus, &now);
+	bus->adapt_intv.bytes = now.bytes - bus->adapt_snap.bytes;
+	bus->adapt_intv.sdxfers = now.sdxfers - bus->adapt_snap.sdxfers;
+	bus->adapt_intv.rxglomframes = now.rxglomframes - bus->adapt_snap.rxglomframes;
+	bus->adapt_intv.rxglompkts = now.rxglompkts - bus->adapt_snap.rxglompkts;
+	bus->adapt_intv.txglomframes = now.txglomframes - bus->adapt_snap.txglomframes;
+	bus->adapt_intv.txglompkts = now.txglompkts - bus->adapt_snap.txglompkts;
+	bus->adapt_intv_ms = msec;
+	bus->adapt_snap = now;
+	bus->adapt_start += msec;
+
+	if (!dhd_adapt_bound)
+		return;
+
+	
+	kbps = (uint32)(((uint64)bus->adapt_intv.bytes * 8) / msec);
+	xfers = (uint32)(((uint64)bus->adapt_intv.sdxfers * 1000) / msec);
+
+	if (kbps >= dhd_adapt_hi_kbps || xfers >= dhd_adapt_hi_xfers) {
+		bus->adapt_lowcnt = 0;
+		if (level < DHD_ADAPT_MAX_LEVEL)
+			level++;
+	} else if (kbps < dhd_adapt_lo_kbps) {
+		if (level && ++bus->adapt_lowcnt >= DHD_ADAPT_DOWN_INTERVALS) {
+			bus->adapt_lowcnt = 0;
+			level--;
+		}
+	} else
+		bus->adapt_lowcnt = 0;
+
+	if (level != bus->adapt_level)
+		dhdsdio_adapt_apply(bus, level);
+}
+
 extern bool
 dhd_bus_watchdog(dhd_pub_t *dhdp)
 {
@@ -6776,6 +6961,9 @@ dhd_bus_watchdog(dhd_pub_t *dhdp)
 		bus->lastintrs = bus->intrcount;
 	}
 
+	if (dhdp->busstate == DHD_BUS_DATA)
+		dhdsdio_adapt_bounds(bus);
+
 #ifdef DHD_DEBUG
 	
 	if (dhdp->busstate == DHD_BUS_DATA && dhd_console_ms != 0) {
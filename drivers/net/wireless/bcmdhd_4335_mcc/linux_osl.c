@@ -707,7 +707,11 @@ osl_pktfree(osl_t *osh, void *p, bool send)
 
 	skb = (struct sk_buff*) p;
 
+#ifdef DHD_BQL
+	if (osh->pub.tx_fn)
+#else
 	if (send && osh->pub.tx_fn)
+#endif
 		osh->pub.tx_fn(osh->pub.tx_ctx, p, 0);
 
 	PKTDBG_TRACE(osh, (void *) skb, PKTLIST_PKTFREE);
@@ -737,6 +737,7 @@ struct ext4_inode_info {
 #define EXT4_MOUNT_DIOREAD_NOLOCK	0x400000 
 #define EXT4_MOUNT_JOURNAL_CHECKSUM	0x800000 
 #define EXT4_MOUNT_JOURNAL_ASYNC_COMMIT	0x1000000 
+#define EXT4_MOUNT_AU_ALIGN		0x2000000 
 #define EXT4_MOUNT_MBLK_IO_SUBMIT	0x4000000 
 #define EXT4_MOUNT_DELALLOC		0x8000000 
 #define EXT4_MOUNT_DATA_ERR_ABORT	0x10000000 
@@ -959,6 +960,7 @@ struct ext4_sb_info {
 
 	
 	unsigned long s_stripe;
+	unsigned long s_au_blocks;
 	unsigned int s_mb_stream_request;
 	unsigned int s_mb_max_to_scan;
 	unsigned int s_mb_min_to_scan;
@@ -1029,6 +1031,12 @@ static inline struct ext4_inode_info *EXT4_I(struct inode *inode)
 	return container_of(inode, struct ext4_inode_info, vfs_inode);
 }
 
+static inline unsigned long ext4_au_pages(struct super_block *sb)
+{
+	return max(1UL, EXT4_SB(sb)->s_au_blocks >>
+			(PAGE_CACHE_SHIFT - sb->s_blocksize_bits));
+}
+
 static inline struct timespec ext4_current_time(struct inode *inode)
 {
 	return (inode->i_sb->s_time_gran < NSEC_PER_SEC) ?
@@ -1509,6 +1517,7 @@ extern void ext4_end_bitmap_read(struct buffer_head *bh, int uptodate);
 extern long ext4_mb_stats;
 extern long ext4_mb_max_to_scan;
 extern int ext4_mb_init(struct super_block *, int);
+extern void ext4_mb_set_group_prealloc(struct super_block *);
 extern int ext4_mb_release(struct super_block *);
 extern ext4_fsblk_t ext4_mb_new_blocks(handle_t *,
 				struct ext4_allocation_request *, int *);
@@ -1688,6 +1688,8 @@ static int ext4_da_writepages(struct address_space *mapping,
 	range_cyclic = wbc->range_cyclic;
 	if (wbc->range_cyclic) {
 		index = mapping->writeback_index;
+		if (sbi->s_au_blocks)
+			index = round_down(index, ext4_au_pages(inode->i_sb));
 		if (index)
 			cycled = 0;
 		wbc->range_start = index << PAGE_CACHE_SHIFT;
@@ -1726,6 +1728,9 @@ static int ext4_da_writepages(struct address_space *mapping,
 							   max_pages);
 	if (desired_nr_to_write > max_pages)
 		desired_nr_to_write = max_pages;
+	if (sbi->s_au_blocks && desired_nr_to_write != LONG_MAX)
+		desired_nr_to_write = round_up(desired_nr_to_write,
+					       ext4_au_pages(inode->i_sb));
 
 	if (wbc->nr_to_write < desired_nr_to_write) {
 		nr_to_writebump = desired_nr_to_write - wbc->nr_to_write;
@@ -1812,6 +1812,22 @@ static int ext4_groupinfo_create_slab(size_t size)
 	return 0;
 }
 
+/*
+ * Locality group preallocations are rounded to the stripe, which is
+ * the allocation unit with au_align, so that they fill whole units.
+ */
+void ext4_mb_set_group_prealloc(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+
+	sbi->s_mb_group_prealloc = max(MB_DEFAULT_GROUP_PREALLOC >>
+				       sbi->s_cluster_bits, 32);
+	if (sbi->s_stripe > 1) {
+		sbi->s_mb_group_prealloc = roundup(
+			sbi->s_mb_group_prealloc, sbi->s_stripe);
+	}
+}
+
 int ext4_mb_init(struct super_block *sb, int needs_recovery)
 {
 	struct ext4_sb_info *sbi = EXT4_SB(sb);
@@ -1862,12 +1878,7 @@ int ext4_mb_init(struct super_block *sb, int needs_recovery)
 	sbi->s_mb_stats = MB_DEFAULT_STATS;
 	sbi->s_mb_stream_request = MB_DEFAULT_STREAM_THRESHOLD;
 	sbi->s_mb_order2_reqs = MB_DEFAULT_ORDER2_REQS;
-	sbi->s_mb_group_prealloc = max(MB_DEFAULT_GROUP_PREALLOC >>
-				       sbi->s_cluster_bits, 32);
-	if (sbi->s_stripe > 1) {
-		sbi->s_mb_group_prealloc = roundup(
-			sbi->s_mb_group_prealloc, sbi->s_stripe);
-	}
+	ext4_mb_set_group_prealloc(sb);
 
 	sbi->s_locality_groups = alloc_percpu(struct ext4_locality_group);
 	if (sbi->s_locality_groups == NULL) {
@@ -2302,6 +2313,22 @@ ext4_mb_normalize_request(struct ext4_allocation_context *ac,
 		start_off = (loff_t)ac->ac_o_ex.fe_logical << bsbits;
 		size	  = ac->ac_o_ex.fe_len << bsbits;
 	}
+
+	/*
+	 * With au_align, requests of at least an allocation unit cover
+	 * whole AUs, so that mballoc can place them on AU boundaries.
+	 */
+	if (sbi->s_au_blocks && size >= (sbi->s_au_blocks << bsbits)) {
+		loff_t au = sbi->s_au_blocks << bsbits;
+		loff_t end_off = round_up(start_off + size, au);
+
+		start_off = round_down(start_off, au);
+		if (end_off - start_off <=
+		    ((loff_t)EXT4_BLOCKS_PER_GROUP(ac->ac_sb) << bsbits))
+			size = end_off - start_off;
+		else
+			start_off = (loff_t)ac->ac_o_ex.fe_logical << bsbits;
+	}
 	size = size >> bsbits;
 	start = start_off >> bsbits;
 
@@ -1106,6 +1106,7 @@ enum {
 	Opt_inode_readahead_blks, Opt_journal_ioprio,
 	Opt_dioread_nolock, Opt_dioread_lock,
 	Opt_discard, Opt_nodiscard, Opt_init_itable, Opt_noinit_itable,
+	Opt_au_align, Opt_noau_align,
 };
 
 static const match_table_t tokens = {
@@ -1161,6 +1162,8 @@ static const match_table_t tokens = {
 	{Opt_nobarrier, "nobarrier"},
 	{Opt_i_version, "i_version"},
 	{Opt_stripe, "stripe=%u"},
+	{Opt_au_align, "au_align"},
+	{Opt_noau_align, "noau_align"},
 	{Opt_delalloc, "delalloc"},
 	{Opt_nodelalloc, "nodelalloc"},
 	{Opt_mblk_io_submit, "mblk_io_submit"},
@@ -1322,6 +1325,8 @@ static const struct mount_opts {
 	{Opt_inode_readahead_blks, 0, MOPT_GTE0},
 	{Opt_init_itable, 0, MOPT_GTE0},
 	{Opt_stripe, 0, MOPT_GTE0},
+	{Opt_au_align, EXT4_MOUNT_AU_ALIGN, MOPT_SET},
+	{Opt_noau_align, EXT4_MOUNT_AU_ALIGN, MOPT_CLEAR},
 	{Opt_data_journal, EXT4_MOUNT_JOURNAL_DATA, MOPT_DATAJ},
 	{Opt_data_ordered, EXT4_MOUNT_ORDERED_DATA, MOPT_DATAJ},
 	{Opt_data_writeback, EXT4_MOUNT_WRITEBACK_DATA, MOPT_DATAJ},
@@ -1668,7 +1673,7 @@ static int _ext4_show_options(struct seq_file *seq, struct super_block *sb,
 		SEQ_OPTS_PRINT("max_batch_time=%u", sbi->s_max_batch_time);
 	if (sb->s_flags & MS_I_VERSION)
 		SEQ_OPTS_PUTS("i_version");
-	if (nodefs || sbi->s_stripe)
+	if (nodefs || (sbi->s_stripe && sbi->s_stripe != sbi->s_au_blocks))
 		SEQ_OPTS_PRINT("stripe=%lu", sbi->s_stripe);
 	if (EXT4_MOUNT_DATA_FLAGS & (sbi->s_mount_opt ^ def_mount_opt)) {
 		if (test_opt(sb, DATA_FLAGS) == EXT4_MOUNT_JOURNAL_DATA)
@@ -2145,6 +2150,49 @@ static unsigned long ext4_get_stripe_size(struct ext4_sb_info *sbi)
 	return ret;
 }
 
+/*
+ * Allocation unit (erase block) size of the underlying flash device in
+ * filesystem blocks, as exported through the discard granularity by the
+ * MMC block driver, or 0 if unknown or unusable.
+ */
+static unsigned long ext4_get_au_size(struct super_block *sb)
+{
+	struct request_queue *q = bdev_get_queue(sb->s_bdev);
+	unsigned int au = q->limits.discard_granularity;
+
+	if (!au)
+		au = queue_io_opt(q);
+	if (!au || !is_power_of_2(au) || au <= sb->s_blocksize ||
+	    (au >> sb->s_blocksize_bits) > EXT4_BLOCKS_PER_GROUP(sb))
+		return 0;
+
+	if ((get_start_sect(sb->s_bdev) << 9) & (au - 1)) {
+		ext4_msg(sb, KERN_WARNING,
+			 "partition is not aligned to the %u byte "
+			 "allocation unit, disabling au_align", au);
+		return 0;
+	}
+
+	return au >> sb->s_blocksize_bits;
+}
+
+/*
+ * Apply the au_align option. A stripe that was only derived from the
+ * allocation unit follows it; an explicit or on-disk stripe is kept.
+ */
+static void ext4_set_au_blocks(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+
+	if (sbi->s_au_blocks && sbi->s_stripe == sbi->s_au_blocks) {
+		sbi->s_stripe = 0;
+		sbi->s_stripe = ext4_get_stripe_size(sbi);
+	}
+	sbi->s_au_blocks = test_opt(sb, AU_ALIGN) ? ext4_get_au_size(sb) : 0;
+	if (!sbi->s_stripe)
+		sbi->s_stripe = sbi->s_au_blocks;
+}
+
 
 struct ext4_attr {
 	struct attribute attr;
@@ -3264,6 +3312,7 @@ static int ext4_fill_super(struct super_block *sb, void *data, int silent)
 	}
 
 	sbi->s_stripe = ext4_get_stripe_size(sbi);
+	ext4_set_au_blocks(sb);
 	sbi->s_max_writeback_mb_bump = 128;
 
 	if (!test_opt(sb, NOLOAD) &&
@@ -3950,6 +3999,8 @@ struct ext4_mount_options {
 	gid_t s_resgid;
 	unsigned long s_commit_interval;
 	u32 s_min_batch_time, s_max_batch_time;
+	unsigned long s_stripe, s_au_blocks;
+	unsigned int s_mb_group_prealloc;
 #ifdef CONFIG_QUOTA
 	int s_jquota_fmt;
 	char *s_qf_names[MAXQUOTAS];
@@ -3981,6 +4032,9 @@ static int ext4_remount(struct super_block *sb, int *flags, char *data)
 	old_opts.s_commit_interval = sbi->s_commit_interval;
 	old_opts.s_min_batch_time = sbi->s_min_batch_time;
 	old_opts.s_max_batch_time = sbi->s_max_batch_time;
+	old_opts.s_stripe = sbi->s_stripe;
+	old_opts.s_au_blocks = sbi->s_au_blocks;
+	old_opts.s_mb_group_prealloc = sbi->s_mb_group_prealloc;
 #ifdef CONFIG_QUOTA
 	old_opts.s_jquota_fmt = sbi->s_jquota_fmt;
 	for (i = 0; i < MAXQUOTAS; i++)
@@ -4009,6 +4063,10 @@ static int ext4_remount(struct super_block *sb, int *flags, char *data)
 		}
 	}
 
+	ext4_set_au_blocks(sb);
+	if (sbi->s_stripe != old_opts.s_stripe)
+		ext4_mb_set_group_prealloc(sb);
+
 	if (sbi->s_mount_flags & EXT4_MF_FS_ABORTED)
 		ext4_abort(sb, "Abort forced by user");
 
@@ -4122,6 +4180,9 @@ restore_opts:
 	sbi->s_commit_interval = old_opts.s_commit_interval;
 	sbi->s_min_batch_time = old_opts.s_min_batch_time;
 	sbi->s_max_batch_time = old_opts.s_max_batch_time;
+	sbi->s_stripe = old_opts.s_stripe;
+	sbi->s_au_blocks = old_opts.s_au_blocks;
+	sbi->s_mb_group_prealloc = old_opts.s_mb_group_prealloc;
 #ifdef CONFIG_QUOTA
 	sbi->s_jquota_fmt = old_opts.s_jquota_fmt;
 	for (i = 0; i < MAXQUOTAS; i++) {
@@ -867,6 +867,18 @@ static void wait_sb_inodes(struct super_block *sb)
 void writeback_inodes_sb_nr(struct super_block *sb,
 			    unsigned long nr,
 			    enum wb_reason reason)
+{
+	writeback_inodes_sb_nr_written(sb, nr, reason);
+}
+EXPORT_SYMBOL(writeback_inodes_sb_nr);
+
+/*
+ * Same as writeback_inodes_sb_nr(), but returns the number of pages the
+ * flusher wrote for this super_block.
+ */
+long writeback_inodes_sb_nr_written(struct super_block *sb,
+				    unsigned long nr,
+				    enum wb_reason reason)
 {
 	DECLARE_COMPLETION_ONSTACK(done);
 	struct wb_writeback_work work = {
@@ -881,8 +893,8 @@ void writeback_inodes_sb_nr(struct super_block *sb,
 	WARN_ON(!rwsem_is_locked(&sb->s_umount));
 	bdi_queue_work(sb->s_bdi, &work);
 	wait_for_completion(&done);
+	return nr - work.nr_pages;
 }
-EXPORT_SYMBOL(writeback_inodes_sb_nr);
 
 /**
  * writeback_inodes_sb	-	writeback dirty inodes from given super_block
@@ -1122,6 +1122,25 @@ static const struct pipe_buf_operations fuse_dev_pipe_buf_ops = {
 	.get = generic_pipe_buf_get,
 };
 
+/*
+ * A WRITE request is spliced as one buffer for the header plus one
+ * reference per payload page.  Make sure the pipe can hold a full-sized
+ * request, so large writes take the zero-copy path instead of failing.
+ */
+static void fuse_dev_splice_grow(struct pipe_inode_info *pipe)
+{
+	unsigned long nr_pages = roundup_pow_of_two(FUSE_MAX_PAGES_PER_REQ + 1);
+
+	if (pipe->buffers >= nr_pages ||
+	    (nr_pages << PAGE_SHIFT) > pipe_max_size)
+		return;
+
+	pipe_lock(pipe);
+	if (pipe->buffers < nr_pages)
+		pipe_set_size(pipe, nr_pages);
+	pipe_unlock(pipe);
+}
+
 static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
 				    struct pipe_inode_info *pipe,
 				    size_t len, unsigned int flags)
@@ -1135,6 +1154,8 @@ static ssize_t fuse_dev_splice_read(struct file *in, loff_t *ppos,
 	if (!fc)
 		return -EPERM;
 
+	fuse_dev_splice_grow(pipe);
+
 	bufs = kmalloc(pipe->buffers * sizeof(struct pipe_buffer), GFP_KERNEL);
 	if (!bufs)
 		return -ENOMEM;
@@ -1182,7 +1182,8 @@ static bool update_mtime(unsigned ivalid)
 	return true;
 }
 
-static void iattr_to_fattr(struct iattr *iattr, struct fuse_setattr_in *arg)
+static void iattr_to_fattr(struct iattr *iattr, struct fuse_setattr_in *arg,
+			   bool trust_local_cmtime)
 {
 	unsigned ivalid = iattr->ia_valid;
 
@@ -1201,13 +1202,19 @@ static void iattr_to_fattr(struct iattr *iattr, struct fuse_setattr_in *arg)
 		if (!(ivalid & ATTR_ATIME_SET))
 			arg->valid |= FATTR_ATIME_NOW;
 	}
-	if ((ivalid & ATTR_MTIME) && update_mtime(ivalid)) {
+	if ((ivalid & ATTR_MTIME) &&
+	    (trust_local_cmtime || update_mtime(ivalid))) {
 		arg->valid |= FATTR_MTIME;
 		arg->mtime = iattr->ia_mtime.tv_sec;
 		arg->mtimensec = iattr->ia_mtime.tv_nsec;
-		if (!(ivalid & ATTR_MTIME_SET))
+		if (!(ivalid & ATTR_MTIME_SET) && !trust_local_cmtime)
 			arg->valid |= FATTR_MTIME_NOW;
 	}
+	if ((ivalid & ATTR_CTIME) && trust_local_cmtime) {
+		arg->valid |= FATTR_CTIME;
+		arg->ctime = iattr->ia_ctime.tv_sec;
+		arg->ctimensec = iattr->ia_ctime.tv_nsec;
+	}
 }
 
 void fuse_set_nowrite(struct inode *inode)
@@ -1252,7 +1259,9 @@ static int fuse_do_setattr(struct dentry *entry, struct iattr *attr,
 	struct fuse_setattr_in inarg;
 	struct fuse_attr_out outarg;
 	bool is_truncate = false;
-	loff_t oldsize;
+	bool trust_local_cmtime = fc->writeback_cache &&
+				  S_ISREG(inode->i_mode);
+	loff_t oldsize, newsize;
 	int err;
 
 	if (!fuse_allow_task(fc, current))
@@ -1274,6 +1283,19 @@ static int fuse_do_setattr(struct dentry *entry, struct iattr *attr,
 	if (attr->ia_valid & ATTR_SIZE)
 		is_truncate = true;
 
+	/*
+	 * With the writeback cache the daemon only learns the size and
+	 * times of a file from us, so flush cached data before resizing
+	 * and pass the cached times along with every setattr.
+	 */
+	if (is_truncate && trust_local_cmtime) {
+		err = filemap_write_and_wait(inode->i_mapping);
+		if (err)
+			return err;
+		if (attr->ia_size != i_size_read(inode))
+			attr->ia_valid |= ATTR_MTIME | ATTR_CTIME;
+	}
+
 	req = fuse_get_req(fc);
 	if (IS_ERR(req))
 		return PTR_ERR(req);
@@ -1285,7 +1307,19 @@ static int fuse_do_setattr(struct dentry *entry, struct iattr *attr,
 
 	memset(&inarg, 0, sizeof(inarg));
 	memset(&outarg, 0, sizeof(outarg));
-	iattr_to_fattr(attr, &inarg);
+	iattr_to_fattr(attr, &inarg, trust_local_cmtime);
+	if (trust_local_cmtime) {
+		if (!(inarg.valid & FATTR_MTIME)) {
+			inarg.valid |= FATTR_MTIME;
+			inarg.mtime = inode->i_mtime.tv_sec;
+			inarg.mtimensec = inode->i_mtime.tv_nsec;
+		}
+		if (!(inarg.valid & FATTR_CTIME)) {
+			inarg.valid |= FATTR_CTIME;
+			inarg.ctime = inode->i_ctime.tv_sec;
+			inarg.ctimensec = inode->i_ctime.tv_nsec;
+		}
+	}
 	if (file) {
 		struct fuse_file *ff = file->private_data;
 		inarg.valid |= FATTR_FH;
@@ -1326,7 +1360,10 @@ static int fuse_do_setattr(struct dentry *entry, struct iattr *attr,
 	fuse_change_attributes_common(inode, &outarg.attr,
 				      attr_timeout(&outarg));
 	oldsize = inode->i_size;
-	i_size_write(inode, outarg.attr.size);
+	newsize = outarg.attr.size;
+	if (trust_local_cmtime)
+		newsize = is_truncate ? attr->ia_size : oldsize;
+	i_size_write(inode, newsize);
 
 	if (is_truncate) {
 		
@@ -1334,9 +1371,10 @@ static int fuse_do_setattr(struct dentry *entry, struct iattr *attr,
 	}
 	spin_unlock(&fc->lock);
 
-	if (S_ISREG(inode->i_mode) && oldsize != outarg.attr.size) {
-		truncate_pagecache(inode, oldsize, outarg.attr.size);
-		invalidate_inode_pages2(inode->i_mapping);
+	if (S_ISREG(inode->i_mode) && oldsize != newsize) {
+		truncate_pagecache(inode, oldsize, newsize);
+		if (!trust_local_cmtime)
+			invalidate_inode_pages2(inode->i_mapping);
 	}
 
 	clear_bit(FUSE_I_SIZE_UNSTABLE, &fi->state);
@@ -429,6 +429,9 @@ struct fuse_conn {
 	
 	unsigned no_flock:1;
 
+	/** Buffer writes in the page cache and write back in batches */
+	unsigned writeback_cache:1;
+
 	
 	atomic_t num_waiting;
 
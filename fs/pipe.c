@@ -1006,7 +1006,7 @@ SYSCALL_DEFINE1(pipe, int __user *, fildes)
 	return sys_pipe2(fildes, 0);
 }
 
-static long pipe_set_size(struct pipe_inode_info *pipe, unsigned long nr_pages)
+long pipe_set_size(struct pipe_inode_info *pipe, unsigned long nr_pages)
 {
 	struct pipe_buffer *bufs;
 
@@ -1040,6 +1040,7 @@ static long pipe_set_size(struct pipe_inode_info *pipe, unsigned long nr_pages)
 	pipe->buffers = nr_pages;
 	return nr_pages * PAGE_SIZE;
 }
+EXPORT_SYMBOL_GPL(pipe_set_size);
 
 static inline unsigned int round_pipe_size(unsigned int size)
 {
@@ -78,6 +78,77 @@ static void sync_filesystems(int wait)
 	iterate_supers(sync_one_sb, &wait);
 }
 
+#define SYNC_BOUNDED_CHUNK	1024
+
+struct sync_bounded_ctl {
+	unsigned long deadline;
+	int nr_sb;
+};
+
+static bool sync_bounded_wants_sb(struct super_block *sb)
+{
+	return !(sb->s_flags & MS_RDONLY) &&
+	       sb->s_bdi != &noop_backing_dev_info;
+}
+
+static void sync_bounded_count_sb(struct super_block *sb, void *arg)
+{
+	struct sync_bounded_ctl *ctl = arg;
+
+	if (sync_bounded_wants_sb(sb))
+		ctl->nr_sb++;
+}
+
+/*
+ * Several filesystems may share one bdi, so progress is judged by the
+ * pages written for this super_block alone. Each filesystem gets an even
+ * share of the time that is left; time it does not need rolls over to
+ * the ones after it.
+ */
+static void sync_bounded_one_sb(struct super_block *sb, void *arg)
+{
+	struct sync_bounded_ctl *ctl = arg;
+	unsigned long sb_deadline;
+	long left;
+
+	if (!sync_bounded_wants_sb(sb))
+		return;
+
+	left = (long)(ctl->deadline - jiffies);
+	if (left > 0 && ctl->nr_sb > 0) {
+		sb_deadline = jiffies + left / ctl->nr_sb;
+		while (time_before(jiffies, sb_deadline)) {
+			if (writeback_inodes_sb_nr_written(sb,
+					SYNC_BOUNDED_CHUNK, WB_REASON_SYNC) <
+			    SYNC_BOUNDED_CHUNK)
+				break;
+		}
+	}
+	if (ctl->nr_sb > 0)
+		ctl->nr_sb--;
+
+	if (sb->s_op->sync_fs)
+		sb->s_op->sync_fs(sb, 1);
+	__sync_blockdev(sb->s_bdev, 1);
+}
+
+/*
+ * Spend at most @budget_ms starting data writeback, then commit every
+ * filesystem's journal and flush its metadata buffers. Unlike sync(2),
+ * dirty data beyond the budget is left to the flusher threads.
+ */
+void sync_filesystems_bounded(unsigned int budget_ms)
+{
+	struct sync_bounded_ctl ctl = {
+		.deadline = jiffies + msecs_to_jiffies(budget_ms),
+	};
+
+	trace_sys_sync(0);
+	iterate_supers(sync_bounded_count_sb, &ctl);
+	iterate_supers(sync_bounded_one_sb, &ctl);
+	trace_sys_sync_done(0);
+}
+
 static void do_sync(void)
 {
 	trace_sys_sync(0);
@@ -128,6 +128,7 @@ extern int cpuidle_wrap_enter(struct cpuidle_device *dev,
 				int (*enter)(struct cpuidle_device *dev,
 					struct cpuidle_driver *drv, int index));
 extern int cpuidle_play_dead(void);
+extern int cpuidle_get_cpu_state(int cpu);
 
 #else
 static inline void disable_cpuidle(void) { }
@@ -151,6 +152,7 @@ static inline int cpuidle_wrap_enter(struct cpuidle_device *dev,
 					struct cpuidle_driver *drv, int index))
 { return -ENODEV; }
 static inline int cpuidle_play_dead(void) {return -ENODEV; }
+static inline int cpuidle_get_cpu_state(int cpu) {return -1; }
 
 #endif
 
@@ -69,6 +69,8 @@ struct fuse_file_lock {
 #define FATTR_ATIME_NOW	(1 << 7)
 #define FATTR_MTIME_NOW	(1 << 8)
 #define FATTR_LOCKOWNER	(1 << 9)
+/* Vendor extension: only sent once FUSE_WRITEBACK_CACHE was negotiated */
+#define FATTR_CTIME	(1 << 10)
 
 #define FOPEN_DIRECT_IO		(1 << 0)
 #define FOPEN_KEEP_CACHE	(1 << 1)
@@ -82,6 +84,12 @@ struct fuse_file_lock {
 #define FUSE_BIG_WRITES		(1 << 5)
 #define FUSE_DONT_MASK		(1 << 6)
 #define FUSE_FLOCK_LOCKS	(1 << 10)
+/*
+ * Vendor extension on top of 7.18, not implied by any minor version.
+ * It has the bit and meaning of the upstream 7.23 flag, so daemons that
+ * know the upstream flag work unchanged.
+ */
+#define FUSE_WRITEBACK_CACHE	(1 << 16)
 
 #define CUSE_UNRESTRICTED_IOCTL	(1 << 0)
 
@@ -237,10 +245,10 @@ struct fuse_setattr_in {
 	__u64	lock_owner;
 	__u64	atime;
 	__u64	mtime;
-	__u64	unused2;
+	__u64	ctime;
 	__u32	atimensec;
 	__u32	mtimensec;
-	__u32	unused3;
+	__u32	ctimensec;
 	__u32	mode;
 	__u32	unused4;
 	__u32	uid;
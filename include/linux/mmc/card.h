@@ -11,6 +11,7 @@
 #define LINUX_MMC_CARD_H
 
 #include <linux/device.h>
+#include <linux/workqueue.h>
 #include <linux/mmc/core.h>
 #include <linux/mod_devicetable.h>
 
@@ -235,6 +236,39 @@ struct mmc_wr_pack_stats {
 	bool print_in_read;
 };
 
+struct mmc_urgent_stats {
+	u32 notified;
+	u32 issued;
+	u32 pack_stopped;
+	u32 preempted_packs;
+	u32 preempted_reqs;
+	u64 preempted_sectors;
+	u64 wait_us;
+	u32 max_wait_us;
+	u64 saved_us;
+	u64 wr_pack_sectors;
+	u64 wr_pack_us;
+	spinlock_t lock;
+};
+
+struct mmc_bkops_stats {
+	u32 idle_started;
+	u32 idle_skipped;
+	u32 urgent_started;
+	u32 interrupted;
+	u64 hpi_us;
+	u32 hpi_max_us;
+	spinlock_t lock;
+};
+
+struct mmc_bkops_info {
+	struct delayed_work	dw;
+	unsigned int		delay_ms;
+	bool			queued;
+	bool			idle_started;
+	struct mmc_bkops_stats	stats;
+};
+
 struct mmc_card {
 	struct mmc_host		*host;		
 	struct device		dev;		
@@ -325,6 +359,9 @@ struct mmc_card {
 	s8			speed_class; 
 
 	struct mmc_wr_pack_stats wr_pack_stats; 
+	struct mmc_wr_pack_stats rd_pack_stats;
+	struct mmc_urgent_stats urgent_stats;
+	struct mmc_bkops_info	bkops_info;
 	int			bkops_check_status;
 	int			need_sanitize;
 };
@@ -551,5 +588,8 @@ extern void mmc_fixup_device(struct mmc_card *card,
 extern struct mmc_wr_pack_stats *mmc_blk_get_packed_statistics(
 			struct mmc_card *card);
 extern void mmc_blk_init_packed_statistics(struct mmc_card *card);
+extern struct mmc_wr_pack_stats *mmc_blk_get_rd_packed_statistics(
+			struct mmc_card *card);
+extern void mmc_blk_init_rd_packed_statistics(struct mmc_card *card);
 
 #endif 
@@ -127,6 +127,9 @@ extern int mmc_send_ext_csd(struct mmc_card *card, u8 *ext_csd);
 extern void mmc_start_bkops(struct mmc_card *card);
 extern int mmc_card_start_sanitize(struct mmc_card *host);
 extern int mmc_card_start_bkops(struct mmc_card *host);
+extern void mmc_init_idle_time_bkops(struct mmc_card *card);
+extern void mmc_start_idle_time_bkops(struct mmc_card *card);
+extern void mmc_stop_idle_time_bkops(struct mmc_card *card);
 #define MMC_WORK_BKOPS		1
 #define MMC_WORK_SANITIZE	2
 extern int mmc_card_stop_work(struct mmc_card *host, int work, int *complete);
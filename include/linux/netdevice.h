@@ -471,6 +471,7 @@ static inline void rps_reset_sock_flow(struct rps_sock_flow_table *table,
 }
 
 extern struct rps_sock_flow_table __rcu *rps_sock_flow_table;
+extern int rps_online_steering;
 
 #ifdef CONFIG_RFS_ACCEL
 extern bool rps_may_expire_flow(struct net_device *dev, u16 rxq_index,
@@ -1434,6 +1435,8 @@ struct softnet_data {
 	unsigned int		time_squeeze;
 	unsigned int		cpu_collision;
 	unsigned int		received_rps;
+	unsigned int		steered_rps;
+	unsigned int		steer_fallback;
 
 #ifdef CONFIG_RPS
 	struct softnet_data	*rps_ipi_list;
@@ -55,6 +55,7 @@ void pipe_double_lock(struct pipe_inode_info *, struct pipe_inode_info *);
 
 extern unsigned int pipe_max_size, pipe_min_size;
 int pipe_proc_fn(struct ctl_table *, int, void __user *, size_t *, loff_t *);
+long pipe_set_size(struct pipe_inode_info *, unsigned long);
 
 
 void pipe_wait(struct pipe_inode_info *pipe);
@@ -821,6 +821,23 @@ unsigned long default_scale_smt_power(struct sched_domain *sd, int cpu);
 
 bool cpus_share_cache(int this_cpu, int that_cpu);
 
+struct sched_power_state {
+	unsigned long freq;
+	unsigned long power;
+};
+
+struct sched_energy_model {
+	const struct sched_power_state *states;
+	int nr_states;
+	unsigned long idle_exit_cost;
+	unsigned long (*cur_freq)(int cpu);
+};
+
+extern void sched_set_energy_model(const struct sched_energy_model *model);
+
+extern unsigned long sched_cpu_runnable_avg(int cpu);
+extern unsigned long sched_cpu_load_avg(int cpu);
+
 #else 
 
 struct sched_domain_attr;
@@ -836,6 +853,16 @@ static inline bool cpus_share_cache(int this_cpu, int that_cpu)
 	return true;
 }
 
+static inline unsigned long sched_cpu_runnable_avg(int cpu)
+{
+	return 0;
+}
+
+static inline unsigned long sched_cpu_load_avg(int cpu)
+{
+	return 0;
+}
+
 #endif	
 
 
@@ -885,6 +912,7 @@ struct sched_class {
 
 #ifdef CONFIG_SMP
 	int  (*select_task_rq)(struct task_struct *p, int sd_flag, int flags);
+	void (*migrate_task_rq)(struct task_struct *p, int next_cpu);
 
 	void (*pre_schedule) (struct rq *this_rq, struct task_struct *task);
 	void (*post_schedule) (struct rq *this_rq);
@@ -919,6 +947,13 @@ struct load_weight {
 	unsigned long weight, inv_weight;
 };
 
+struct sched_avg {
+	u32 runnable_avg_sum, runnable_avg_period;
+	u64 last_runnable_update;
+	s64 decay_count;
+	unsigned long load_avg_contrib;
+};
+
 #ifdef CONFIG_SCHEDSTATS
 struct sched_statistics {
 	u64			wait_start;
@@ -979,6 +1014,10 @@ struct sched_entity {
 	
 	struct cfs_rq		*my_q;
 #endif
+
+#ifdef CONFIG_SMP
+	struct sched_avg	avg;
+#endif
 };
 
 struct sched_rt_entity {
@@ -228,6 +228,8 @@ struct ucred {
 #define MSG_SENDPAGE_NOTLAST 0x20000 
 #define MSG_EOF         MSG_FIN
 
+#define MSG_FASTOPEN	0x20000000
+
 #define MSG_CMSG_CLOEXEC 0x40000000	
 #if defined(CONFIG_COMPAT)
 #define MSG_CMSG_COMPAT	0x80000000	
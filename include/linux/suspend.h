@@ -60,6 +60,11 @@ struct suspend_stats {
 	int	failed_resume;
 	int	failed_resume_early;
 	int	failed_resume_noirq;
+	int	sync_count;
+	int	sync_aborts;
+	unsigned int	sync_last_ms;
+	unsigned int	sync_max_ms;
+	u64	sync_total_ms;
 #define	REC_FAILED_NUM	2
 	int	last_failed_dev;
 	char	failed_devs[REC_FAILED_NUM][40];
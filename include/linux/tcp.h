@@ -97,6 +97,7 @@ enum {
 #define TCP_THIN_LINEAR_TIMEOUTS 16      
 #define TCP_THIN_DUPACK         17      
 #define TCP_USER_TIMEOUT	18	
+#define TCP_FASTOPEN		23
 
 #define TCPI_OPT_TIMESTAMPS	1
 #define TCPI_OPT_SACK		2
@@ -255,8 +256,18 @@ static inline void tcp_clear_options(struct tcp_options_received *rx_opt)
 
 #define TCP_NUM_SACKS 4
 
+#define TCP_FASTOPEN_COOKIE_MIN	4
+#define TCP_FASTOPEN_COOKIE_MAX	16
+#define TCP_FASTOPEN_COOKIE_SIZE 8
+
+struct tcp_fastopen_cookie {
+	s8	len;
+	u8	val[TCP_FASTOPEN_COOKIE_MAX];
+};
+
 struct tcp_cookie_values;
 struct tcp_request_sock_ops;
+struct tcp_fastopen_request;
 
 struct tcp_request_sock {
 	struct inet_request_sock 	req;
@@ -264,9 +275,11 @@ struct tcp_request_sock {
 	
 	const struct tcp_request_sock_ops *af_specific;
 #endif
+	struct sock			*listener;
 	u32				rcv_isn;
 	u32				snt_isn;
 	u32				snt_synack; 
+	u32				rcv_nxt;
 };
 
 static inline struct tcp_request_sock *tcp_rsk(const struct request_sock *req)
@@ -328,7 +341,10 @@ struct tcp_sock {
 		repair      : 1,
 		unused      : 1;
 	u8	repair_queue;
-	u8	do_early_retrans:1;/* Enable RFC5827 early-retransmit  */
+	u8	do_early_retrans:1,/* Enable RFC5827 early-retransmit  */
+		syn_data:1,
+		syn_fastopen:1,
+		syn_data_acked:1;
  
  /* RTT measurement */
 	u32	srtt;		/* smoothed round trip time << 3	*/
@@ -425,6 +441,9 @@ struct tcp_sock {
 #endif
 
 	struct tcp_cookie_values  *cookie_values;
+
+	struct tcp_fastopen_request *fastopen_req;
+	struct request_sock *fastopen_rsk;
 };
 
 enum tsq_flags {
@@ -456,6 +475,12 @@ static inline struct tcp_timewait_sock *tcp_twsk(const struct sock *sk)
 	return (struct tcp_timewait_sock *)sk;
 }
 
+static inline bool tcp_passive_fastopen(const struct sock *sk)
+{
+	return (sk->sk_state == TCP_SYN_RECV &&
+		tcp_sk(sk)->fastopen_rsk != NULL);
+}
+
 #endif	
 
 #endif	
@@ -230,6 +230,23 @@ static inline void timer_stats_timer_clear_start_info(struct timer_list *timer)
 }
 #endif
 
+#ifdef CONFIG_TIMER_WAKEUP_STATS
+extern int timer_wakeup_stats_active;
+
+extern void __timer_wakeup_account(void *fn, int hrtimer);
+
+static inline void timer_wakeup_account(void *fn, int hrtimer)
+{
+	if (likely(!timer_wakeup_stats_active))
+		return;
+	__timer_wakeup_account(fn, hrtimer);
+}
+#else
+static inline void timer_wakeup_account(void *fn, int hrtimer)
+{
+}
+#endif
+
 extern void add_timer(struct timer_list *timer);
 
 extern int try_to_del_timer_sync(struct timer_list *timer);
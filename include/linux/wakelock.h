@@ -18,6 +18,8 @@
 
 #include <linux/list.h>
 #include <linux/ktime.h>
+#include <linux/types.h>
+#include <linux/wakelock_stat.h>
 
 
 enum {
@@ -40,6 +42,8 @@ struct wake_lock {
 		ktime_t         prevent_suspend_time;
 		ktime_t         max_time;
 		ktime_t         last_time;
+		unsigned int    id;
+		unsigned long   change_seq;
 	} stat;
 #endif
 #endif
@@ -71,5 +75,11 @@ static inline long has_wake_lock(int type) { return 0; }
 
 #endif
 
+#ifdef CONFIG_WAKELOCK_STAT
+void wakelock_set_resume_irq(int irq);
+#else
+static inline void wakelock_set_resume_irq(int irq) {}
+#endif
+
 #endif
 
@@ -0,0 +1,65 @@
+/* include/linux/wakelock_stat.h
+ *
+ * Record format of /proc/wakelocks_bin.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _LINUX_WAKELOCK_STAT_H
+#define _LINUX_WAKELOCK_STAT_H
+
+#include <linux/types.h>
+
+#define WAKELOCK_STAT_VERSION		1
+#define WAKELOCK_STAT_NAME_LEN		32
+
+#define WAKELOCK_STAT_FULL		(1U << 0)
+
+#define WAKELOCK_STAT_ACTIVE		(1U << 0)
+#define WAKELOCK_STAT_AUTO_EXPIRE	(1U << 1)
+#define WAKELOCK_STAT_PREVENTING_SUSPEND	(1U << 2)
+#define WAKELOCK_STAT_REMOVED		(1U << 3)
+
+/*
+ * A read at offset 0 returns every lock with WAKELOCK_STAT_FULL set in the
+ * header; the file position is then the change sequence of the snapshot,
+ * so the next read() only returns locks that changed since, plus a
+ * WAKELOCK_STAT_REMOVED record (id and name only) for each destroyed lock.
+ * If removals were lost in between, a full snapshot is returned instead.
+ * With nothing changed, read() returns 0, or -EAGAIN with O_NONBLOCK.
+ * The buffer must hold the header and at least one record.
+ * Times are ns of CLOCK_MONOTONIC; the stats of an active lock are as of
+ * active_since.
+ */
+struct wakelock_stat_header {
+	__u32 version;
+	__u32 nr_records;
+	__u32 flags;
+	__u32 pad;
+	__u64 seq;
+	__s64 now;
+};
+
+struct wakelock_stat_record {
+	__u32 id;
+	__u32 flags;
+	__u32 count;
+	__u32 expire_count;
+	__u32 wakeup_count;
+	__u32 pad;
+	__s64 active_since;
+	__s64 total_time;
+	__s64 prevent_suspend_time;
+	__s64 max_time;
+	char name[WAKELOCK_STAT_NAME_LEN];
+};
+
+#endif
@@ -66,6 +66,8 @@ int inode_wait(void *);
 void writeback_inodes_sb(struct super_block *, enum wb_reason reason);
 void writeback_inodes_sb_nr(struct super_block *, unsigned long nr,
 							enum wb_reason reason);
+long writeback_inodes_sb_nr_written(struct super_block *, unsigned long nr,
+							enum wb_reason reason);
 int writeback_inodes_sb_if_idle(struct super_block *, enum wb_reason reason);
 int writeback_inodes_sb_nr_if_idle(struct super_block *, unsigned long nr,
 							enum wb_reason reason);
@@ -98,6 +98,14 @@ struct listen_sock {
 	struct request_sock	*syn_table[0];
 };
 
+struct fastopen_queue {
+	struct request_sock	*rskq_rst_head;
+	struct request_sock	*rskq_rst_tail;
+	spinlock_t		lock;
+	int			qlen;
+	int			max_qlen;
+};
+
 struct request_sock_queue {
 	struct request_sock	*rskq_accept_head;
 	struct request_sock	*rskq_accept_tail;
@@ -105,6 +113,7 @@ struct request_sock_queue {
 	u8			rskq_defer_accept;
 	
 	struct listen_sock	*listen_opt;
+	struct fastopen_queue	*fastopenq;
 };
 
 extern int reqsk_queue_alloc(struct request_sock_queue *queue,
@@ -112,6 +121,8 @@ extern int reqsk_queue_alloc(struct request_sock_queue *queue,
 
 extern void __reqsk_queue_destroy(struct request_sock_queue *queue);
 extern void reqsk_queue_destroy(struct request_sock_queue *queue);
+extern void reqsk_fastopen_remove(struct sock *sk,
+				  struct request_sock *req, bool reset);
 
 static inline struct request_sock *
 	reqsk_queue_yank_acceptq(struct request_sock_queue *queue)
@@ -158,6 +158,46 @@ TRACE_EVENT(sched_migrate_task,
 		  __entry->orig_cpu, __entry->dest_cpu)
 );
 
+TRACE_EVENT(sched_energy_placement,
+
+	TP_PROTO(struct task_struct *p, int dest_cpu, unsigned long task_load,
+		 unsigned long cost, unsigned long prev_cost, int reason),
+
+	TP_ARGS(p, dest_cpu, task_load, cost, prev_cost, reason),
+
+	TP_STRUCT__entry(
+		__array(	char,	comm,	TASK_COMM_LEN	)
+		__field(	pid_t,	pid			)
+		__field(	int,	prev_cpu		)
+		__field(	int,	dest_cpu		)
+		__field(	unsigned long,	task_load	)
+		__field(	unsigned long,	cost		)
+		__field(	unsigned long,	prev_cost	)
+		__field(	int,	reason			)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, p->comm, TASK_COMM_LEN);
+		__entry->pid		= p->pid;
+		__entry->prev_cpu	= task_cpu(p);
+		__entry->dest_cpu	= dest_cpu;
+		__entry->task_load	= task_load;
+		__entry->cost		= cost;
+		__entry->prev_cost	= prev_cost;
+		__entry->reason		= reason;
+	),
+
+	TP_printk("comm=%s pid=%d prev_cpu=%d dest_cpu=%d load=%lu cost=%lu prev_cost=%lu reason=%s",
+		  __entry->comm, __entry->pid, __entry->prev_cpu,
+		  __entry->dest_cpu, __entry->task_load, __entry->cost,
+		  __entry->prev_cost,
+		  __print_symbolic(__entry->reason,
+				{ 0, "pack" },
+				{ 1, "wake_idle" },
+				{ 2, "big_task" },
+				{ 3, "no_capacity" }))
+);
+
 DECLARE_EVENT_CLASS(sched_process_template,
 
 	TP_PROTO(struct task_struct *p),
@@ -46,6 +46,7 @@
 #include <linux/sched.h>
 #include <linux/timer.h>
 #include <linux/freezer.h>
+#include <linux/moduleparam.h>
 
 #include <asm/uaccess.h>
 
@@ -743,6 +744,28 @@ remove_hrtimer(struct hrtimer *timer, struct hrtimer_clock_base *base)
 	return 0;
 }
 
+/*
+ * A timer with at least coalesce_ns of slack has its hard expiry pulled
+ * back onto a multiple of coalesce_ns, so timers across cpus with
+ * overlapping windows fire from the same interrupt.
+ */
+static unsigned int coalesce_ns = NSEC_PER_MSEC;
+module_param(coalesce_ns, uint, 0644);
+
+static void hrtimer_coalesce(struct hrtimer *timer, unsigned long delta_ns)
+{
+	unsigned int grid = ACCESS_ONCE(coalesce_ns);
+	ktime_t hard = hrtimer_get_expires(timer);
+	u32 rem;
+
+	if (!grid || delta_ns < grid || hard.tv64 <= 0 ||
+	    hard.tv64 == KTIME_MAX)
+		return;
+
+	div_u64_rem(hard.tv64, grid, &rem);
+	timer->node.expires = ktime_sub_ns(hard, rem);
+}
+
 int __hrtimer_start_range_ns(struct hrtimer *timer, ktime_t tim,
 		unsigned long delta_ns, const enum hrtimer_mode mode,
 		int wakeup)
@@ -764,6 +787,7 @@ int __hrtimer_start_range_ns(struct hrtimer *timer, ktime_t tim,
 	}
 
 	hrtimer_set_expires_range_ns(timer, tim, delta_ns);
+	hrtimer_coalesce(timer, delta_ns);
 
 	/* Switch the timer base, if necessary: */
 	new_base = switch_hrtimer_base(timer, base, mode & HRTIMER_MODE_PINNED);
@@ -944,6 +968,7 @@ static void __run_hrtimer(struct hrtimer *timer, ktime_t *now)
 	__remove_hrtimer(timer, base, HRTIMER_STATE_CALLBACK, 0);
 	timer_stats_account_hrtimer(timer);
 	fn = timer->function;
+	timer_wakeup_account(fn, 1);
 
 	raw_spin_unlock(&cpu_base->lock);
 	trace_hrtimer_expire_entry(timer, now);
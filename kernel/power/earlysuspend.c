@@ -13,6 +13,7 @@
  *
  */
 
+#include <linux/async.h>
 #include <linux/earlysuspend.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
@@ -43,6 +44,18 @@ static int debug_mask = DEBUG_USER_STATE;
 
 module_param_named(debug_mask, debug_mask, int, S_IRUGO | S_IWUSR | S_IWGRP);
 
+/*
+ * With parallel set, handlers registered at the same level run
+ * concurrently; all handlers of a level complete before the next level
+ * starts, so cross level ordering is preserved. Handlers that set
+ * async run concurrently with the rest of their level even without it.
+ */
+static bool parallel;
+module_param(parallel, bool, S_IRUGO | S_IWUSR | S_IWGRP);
+
+static unsigned int slow_handler_ms = 20;
+module_param(slow_handler_ms, uint, S_IRUGO | S_IWUSR | S_IWGRP);
+
 static DEFINE_MUTEX(early_suspend_lock);
 static LIST_HEAD(early_suspend_handlers);
 static void early_suspend(struct work_struct *work);
@@ -50,6 +63,8 @@ static void late_resume(struct work_struct *work);
 static DECLARE_WORK(early_suspend_work, early_suspend);
 static DECLARE_WORK(late_resume_work, late_resume);
 static DEFINE_SPINLOCK(state_lock);
+static LIST_HEAD(early_suspend_domain);
+static bool early_suspend_resuming;
 enum {
 	SUSPEND_REQUESTED = 0x1,
 	SUSPENDED = 0x2,
@@ -151,11 +166,58 @@ static void early_suspend_handlers_timeout(unsigned long data)
 	BUG();
 }
 
+static void early_suspend_call(struct early_suspend *pos, bool resume)
+{
+	void (*fn)(struct early_suspend *h) = resume ? pos->resume :
+						       pos->suspend;
+	const char *what = resume ? "late_resume" : "early_suspend";
+	struct timer_list timer;
+	ktime_t start;
+	s64 us;
+
+	setup_timer_on_stack(&timer, early_suspend_handlers_timeout,
+			     (unsigned long)fn);
+	mod_timer(&timer, jiffies + HZ * EARLY_SUSPEND_TIMEOUT_VALUE);
+
+	if (debug_mask & DEBUG_VERBOSE)
+		pr_info("%s: calling %pf\n", what, fn);
+
+	start = ktime_get();
+	fn(pos);
+	us = ktime_us_delta(ktime_get(), start);
+
+	del_timer_sync(&timer);
+	destroy_timer_on_stack(&timer);
+
+	if ((debug_mask & DEBUG_VERBOSE) || us >= slow_handler_ms * 1000LL)
+		pr_info("%s: %pf took %lld us\n", what, fn, us);
+}
+
+static void early_suspend_call_async(void *data, async_cookie_t cookie)
+{
+	early_suspend_call(data, early_suspend_resuming);
+}
+
+static void early_suspend_run(struct early_suspend *pos, int *level)
+{
+	if (pos->level != *level) {
+		async_synchronize_full_domain(&early_suspend_domain);
+		*level = pos->level;
+	}
+
+	if (!parallel && !pos->async) {
+		early_suspend_call(pos, early_suspend_resuming);
+		return;
+	}
+	async_schedule_domain(early_suspend_call_async, pos,
+			      &early_suspend_domain);
+}
+
 static void early_suspend(struct work_struct *work)
 {
 	struct early_suspend *pos;
-	struct timer_list timer;
 	unsigned long irqflags;
+	int level = INT_MIN;
 	int abort = 0;
 
 	pr_info("[R] early_suspend start\n");
@@ -180,26 +242,15 @@ static void early_suspend(struct work_struct *work)
 
 	boost_cpu_speed(1);
 
-	init_timer_on_stack(&timer);
-	timer.function = early_suspend_handlers_timeout;
-
 	if (debug_mask & DEBUG_SUSPEND)
 		pr_info("early_suspend: call handlers\n");
+	early_suspend_resuming = false;
 	list_for_each_entry(pos, &early_suspend_handlers, link) {
-		if (pos->suspend != NULL) {
-			timer.expires = jiffies + HZ * EARLY_SUSPEND_TIMEOUT_VALUE;
-			timer.data = (unsigned long)pos->suspend;
-			add_timer(&timer);
-
-			if (debug_mask & DEBUG_VERBOSE)
-				pr_info("early_suspend: calling %pf\n", pos->suspend);
-
-			pos->suspend(pos);
-			del_timer_sync(&timer);
-		}
+		if (pos->suspend != NULL)
+			early_suspend_run(pos, &level);
 	}
+	async_synchronize_full_domain(&early_suspend_domain);
 
-	destroy_timer_on_stack(&timer);
 	boost_cpu_speed(0);
 	mutex_unlock(&early_suspend_lock);
 
@@ -224,8 +275,8 @@ abort:
 static void late_resume(struct work_struct *work)
 {
 	struct early_suspend *pos;
-	struct timer_list timer;
 	unsigned long irqflags;
+	int level = INT_MIN;
 	int abort = 0;
 
 	pr_info("[R] late_resume start\n");
@@ -248,26 +299,16 @@ static void late_resume(struct work_struct *work)
 	}
 
 	boost_cpu_speed(1);
-	init_timer_on_stack(&timer);
-	timer.function = early_suspend_handlers_timeout;
 
 	if (debug_mask & DEBUG_SUSPEND)
 		pr_info("late_resume: call handlers\n");
+	early_suspend_resuming = true;
 	list_for_each_entry_reverse(pos, &early_suspend_handlers, link) {
-		if (pos->resume != NULL) {
-			timer.expires = jiffies + HZ * EARLY_SUSPEND_TIMEOUT_VALUE;
-			timer.data = (unsigned long)pos->suspend;
-			add_timer(&timer);
-
-			if (debug_mask & DEBUG_VERBOSE)
-				pr_info("late_resume: calling %pf\n", pos->resume);
-
-			pos->resume(pos);
-			del_timer_sync(&timer);
-		}
+		if (pos->resume != NULL)
+			early_suspend_run(pos, &level);
 	}
+	async_synchronize_full_domain(&early_suspend_domain);
 
-	destroy_timer_on_stack(&timer);
 	boost_cpu_speed(0);
 
 	if (debug_mask & DEBUG_SUSPEND)
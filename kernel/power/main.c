@@ -265,6 +265,13 @@ static int suspend_stats_show(struct seq_file *s, void *unused)
 				suspend_stats.failed_resume_early,
 			"failed_resume_noirq",
 				suspend_stats.failed_resume_noirq);
+	seq_printf(s, "%s: %d\n%s: %d\n%s: %u\n%s: %u\n%s: %llu\n",
+			"sync_count", suspend_stats.sync_count,
+			"sync_aborts", suspend_stats.sync_aborts,
+			"sync_last_ms", suspend_stats.sync_last_ms,
+			"sync_max_ms", suspend_stats.sync_max_ms,
+			"sync_total_ms",
+				(unsigned long long)suspend_stats.sync_total_ms);
 	seq_printf(s,	"failures:\n  last_failed_dev:\t%-s\n",
 			suspend_stats.failed_devs[last_dev]);
 	for (i = 1; i < REC_FAILED_NUM; i++) {
@@ -23,6 +23,8 @@
 #include <mach/board_htc.h>
 #ifdef CONFIG_WAKELOCK_STAT
 #include <linux/proc_fs.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
 #endif
 #include "power.h"
 
@@ -36,6 +38,15 @@ enum {
 static int debug_mask = DEBUG_EXIT_SUSPEND | DEBUG_WAKEUP;
 module_param_named(debug_mask, debug_mask, int, S_IRUGO | S_IWUSR | S_IWGRP);
 
+enum {
+	SUSPEND_SYNC_FULL,
+	SUSPEND_SYNC_BOUNDED,
+};
+static int suspend_sync_mode = SUSPEND_SYNC_BOUNDED;
+module_param(suspend_sync_mode, int, S_IRUGO | S_IWUSR | S_IWGRP);
+static unsigned int suspend_sync_budget_ms = 200;
+module_param(suspend_sync_budget_ms, uint, S_IRUGO | S_IWUSR | S_IWGRP);
+
 #define WAKE_LOCK_TYPE_MASK              (0x0f)
 #define WAKE_LOCK_INITIALIZED            (1U << 8)
 #define WAKE_LOCK_ACTIVE                 (1U << 9)
@@ -66,6 +77,40 @@ static unsigned suspend_short_count;
 static struct wake_lock deleted_wake_locks;
 static ktime_t last_sleep_time_update;
 static int wait_for_wakeup;
+static unsigned int wake_lock_next_id;
+static unsigned int wake_lock_count;
+static unsigned long wake_lock_stat_seq;
+
+#define REMOVED_LOG_SIZE	32
+
+struct removed_log_entry {
+	unsigned int id;
+	unsigned long seq;
+	char name[WAKELOCK_STAT_NAME_LEN];
+};
+
+static struct removed_log_entry removed_log[REMOVED_LOG_SIZE];
+static unsigned int removed_log_count;
+static unsigned long removed_log_lost_seq;
+
+#define RESUME_LOG_SIZE	16
+
+struct resume_log_entry {
+	ktime_t time;
+	int irq;
+	char source[WAKELOCK_STAT_NAME_LEN];
+};
+
+static struct resume_log_entry resume_log[RESUME_LOG_SIZE];
+static unsigned int resume_log_count;
+static struct resume_log_entry *resume_log_open;
+static int resume_irq = -1;
+static char resume_source[WAKELOCK_STAT_NAME_LEN];
+
+static inline void wake_lock_stat_changed(struct wake_lock *lock)
+{
+	lock->stat.change_seq = ++wake_lock_stat_seq;
+}
 
 int get_expired_time(struct wake_lock *lock, ktime_t *expire_time)
 {
@@ -172,6 +217,7 @@ static void wake_unlock_stat_locked(struct wake_lock *lock, int expired)
 			lock->stat.prevent_suspend_time, duration);
 		lock->flags &= ~WAKE_LOCK_PREVENTING_SUSPEND;
 	}
+	wake_lock_stat_changed(lock);
 }
 
 static void update_sleep_wait_stats_locked(int done)
@@ -196,9 +242,218 @@ static void update_sleep_wait_stats_locked(int done)
 			lock->flags &= ~WAKE_LOCK_PREVENTING_SUSPEND;
 		else
 			lock->flags |= WAKE_LOCK_PREVENTING_SUSPEND;
+		wake_lock_stat_changed(lock);
 	}
 	last_sleep_time_update = now;
 }
+
+static void wake_lock_fill_record(struct wake_lock *lock,
+				  struct wakelock_stat_record *rec)
+{
+	rec->id = lock->stat.id;
+	rec->flags = 0;
+	if (lock->flags & WAKE_LOCK_ACTIVE) {
+		rec->flags |= WAKELOCK_STAT_ACTIVE;
+		rec->active_since = ktime_to_ns(lock->stat.last_time);
+	}
+	if (lock->flags & WAKE_LOCK_AUTO_EXPIRE)
+		rec->flags |= WAKELOCK_STAT_AUTO_EXPIRE;
+	if (lock->flags & WAKE_LOCK_PREVENTING_SUSPEND)
+		rec->flags |= WAKELOCK_STAT_PREVENTING_SUSPEND;
+	rec->count = lock->stat.count;
+	rec->expire_count = lock->stat.expire_count;
+	rec->wakeup_count = lock->stat.wakeup_count;
+	rec->total_time = ktime_to_ns(lock->stat.total_time);
+	rec->prevent_suspend_time =
+		ktime_to_ns(lock->stat.prevent_suspend_time);
+	rec->max_time = ktime_to_ns(lock->stat.max_time);
+	strlcpy(rec->name, lock->name, sizeof(rec->name));
+}
+
+static void wake_lock_removed_locked(struct wake_lock *lock)
+{
+	struct removed_log_entry *entry;
+
+	entry = &removed_log[removed_log_count++ % REMOVED_LOG_SIZE];
+	if (removed_log_count > REMOVED_LOG_SIZE)
+		removed_log_lost_seq = entry->seq;
+	entry->id = lock->stat.id;
+	entry->seq = ++wake_lock_stat_seq;
+	strlcpy(entry->name, lock->name, sizeof(entry->name));
+}
+
+static int wake_lock_collect_removed(unsigned long since,
+				     struct wakelock_stat_record *recs,
+				     size_t max, size_t *n)
+{
+	struct removed_log_entry *entry;
+	unsigned int i;
+
+	for (i = 0; i < min_t(unsigned int, removed_log_count,
+			      REMOVED_LOG_SIZE); i++) {
+		entry = &removed_log[i];
+		if ((long)(entry->seq - since) <= 0)
+			continue;
+		if (*n >= max)
+			return -ENOSPC;
+		recs[*n].id = entry->id;
+		recs[*n].flags = WAKELOCK_STAT_REMOVED;
+		strlcpy(recs[*n].name, entry->name, sizeof(recs[*n].name));
+		(*n)++;
+	}
+	return 0;
+}
+
+static int wake_lock_collect_records(struct list_head *head,
+				     unsigned long since,
+				     struct wakelock_stat_record *recs,
+				     size_t max, size_t *n)
+{
+	struct wake_lock *lock;
+
+	list_for_each_entry(lock, head, link) {
+		if (since && (long)(lock->stat.change_seq - since) <= 0)
+			continue;
+		if (*n >= max)
+			return -ENOSPC;
+		wake_lock_fill_record(lock, &recs[(*n)++]);
+	}
+	return 0;
+}
+
+static ssize_t wakelock_bin_read(struct file *file, char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	struct wakelock_stat_header hdr;
+	struct wakelock_stat_record *recs;
+	unsigned long since = *ppos;
+	unsigned long irqflags;
+	size_t max, n = 0;
+	int type, ret = 0;
+
+	if (count < sizeof(hdr) + sizeof(*recs))
+		return -EINVAL;
+
+	max = min_t(size_t, (count - sizeof(hdr)) / sizeof(*recs),
+		    ACCESS_ONCE(wake_lock_count) + REMOVED_LOG_SIZE + 16);
+	recs = kzalloc(max * sizeof(*recs), GFP_KERNEL);
+	if (!recs)
+		return -ENOMEM;
+
+	hdr.flags = 0;
+	spin_lock_irqsave(&list_lock, irqflags);
+	if (since && removed_log_lost_seq &&
+	    (long)(removed_log_lost_seq - since) > 0)
+		since = 0;
+	if (since)
+		ret = wake_lock_collect_removed(since, recs, max, &n);
+	else
+		hdr.flags |= WAKELOCK_STAT_FULL;
+	if (!ret)
+		ret = wake_lock_collect_records(&inactive_locks, since, recs,
+						max, &n);
+	for (type = 0; !ret && type < WAKE_LOCK_TYPE_COUNT; type++)
+		ret = wake_lock_collect_records(&active_wake_locks[type], since,
+						recs, max, &n);
+	hdr.seq = wake_lock_stat_seq;
+	spin_unlock_irqrestore(&list_lock, irqflags);
+
+	if (ret)
+		goto out;
+
+	ret = 0;
+	if (since && !n) {
+		if (file->f_flags & O_NONBLOCK)
+			ret = -EAGAIN;
+		goto out;
+	}
+
+	hdr.version = WAKELOCK_STAT_VERSION;
+	hdr.nr_records = n;
+	hdr.pad = 0;
+	hdr.now = ktime_to_ns(ktime_get());
+
+	ret = -EFAULT;
+	if (copy_to_user(buf, &hdr, sizeof(hdr)) ||
+	    copy_to_user(buf + sizeof(hdr), recs, n * sizeof(*recs)))
+		goto out;
+
+	*ppos = hdr.seq;
+	ret = sizeof(hdr) + n * sizeof(*recs);
+out:
+	kfree(recs);
+	return ret;
+}
+
+static const struct file_operations wakelock_bin_fops = {
+	.owner = THIS_MODULE,
+	.read = wakelock_bin_read,
+	.llseek = default_llseek,
+};
+
+void wakelock_set_resume_irq(int irq)
+{
+	if (resume_irq < 0)
+		resume_irq = irq;
+}
+
+static void resume_log_add(void)
+{
+	struct resume_log_entry *entry;
+	unsigned long irqflags;
+
+	spin_lock_irqsave(&list_lock, irqflags);
+	entry = &resume_log[resume_log_count++ % RESUME_LOG_SIZE];
+	entry->time = ktime_get();
+	entry->irq = resume_irq;
+	strlcpy(entry->source, resume_source, sizeof(entry->source));
+	resume_log_open = wait_for_wakeup ? entry : NULL;
+	resume_source[0] = '\0';
+	spin_unlock_irqrestore(&list_lock, irqflags);
+}
+
+static void resume_log_attribute_locked(struct wake_lock *lock)
+{
+	if (resume_log_open) {
+		strlcpy(resume_log_open->source, lock->name,
+			sizeof(resume_log_open->source));
+		resume_log_open = NULL;
+	} else {
+		strlcpy(resume_source, lock->name, sizeof(resume_source));
+	}
+}
+
+static int resume_log_show(struct seq_file *m, void *unused)
+{
+	struct resume_log_entry *entry;
+	unsigned long irqflags;
+	unsigned int i;
+
+	spin_lock_irqsave(&list_lock, irqflags);
+	seq_puts(m, "resume_time\tirq\twakeup_source\n");
+	i = resume_log_count > RESUME_LOG_SIZE ?
+		resume_log_count - RESUME_LOG_SIZE : 0;
+	for (; i < resume_log_count; i++) {
+		entry = &resume_log[i % RESUME_LOG_SIZE];
+		seq_printf(m, "%lld\t%d\t\"%s\"\n", ktime_to_ns(entry->time),
+			   entry->irq, entry->source);
+	}
+	spin_unlock_irqrestore(&list_lock, irqflags);
+	return 0;
+}
+
+static int resume_log_open_fs(struct inode *inode, struct file *file)
+{
+	return single_open(file, resume_log_show, NULL);
+}
+
+static const struct file_operations resume_log_fops = {
+	.owner = THIS_MODULE,
+	.open = resume_log_open_fs,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
 #endif
 
 
@@ -296,17 +551,30 @@ long has_wake_lock(int type)
 
 static void suspend_sys_sync(struct work_struct *work)
 {
+	ktime_t start;
+	unsigned int ms;
+
 	if (debug_mask & DEBUG_SUSPEND)
 		pr_info("PM: Syncing filesystems...\n");
 
-	sys_sync();
+	start = ktime_get();
+	if (suspend_sync_mode == SUSPEND_SYNC_FULL)
+		sys_sync();
+	else
+		sync_filesystems_bounded(suspend_sync_budget_ms);
+	ms = ktime_to_ms(ktime_sub(ktime_get(), start));
 
 	if (debug_mask & DEBUG_SUSPEND)
-		pr_info("sync done.\n");
+		pr_info("sync done in %u ms.\n", ms);
 
-	spin_lock(&suspend_sys_sync_lock);
+	spin_lock_bh(&suspend_sys_sync_lock);
 	suspend_sys_sync_count--;
-	spin_unlock(&suspend_sys_sync_lock);
+	suspend_stats.sync_count++;
+	suspend_stats.sync_last_ms = ms;
+	suspend_stats.sync_total_ms += ms;
+	if (ms > suspend_stats.sync_max_ms)
+		suspend_stats.sync_max_ms = ms;
+	spin_unlock_bh(&suspend_sys_sync_lock);
 }
 static DECLARE_WORK(suspend_sys_sync_work, suspend_sys_sync);
 
@@ -314,11 +582,11 @@ void suspend_sys_sync_queue(void)
 {
 	int ret;
 
-	spin_lock(&suspend_sys_sync_lock);
+	spin_lock_bh(&suspend_sys_sync_lock);
 	ret = queue_work(suspend_sys_sync_work_queue, &suspend_sys_sync_work);
 	if (ret)
 		suspend_sys_sync_count++;
-	spin_unlock(&suspend_sys_sync_lock);
+	spin_unlock_bh(&suspend_sys_sync_lock);
 }
 
 static bool suspend_sys_sync_abort;
@@ -331,6 +599,9 @@ static void suspend_sys_sync_handler(unsigned long arg)
 		complete(&suspend_sys_sync_comp);
 	} else if (has_wake_lock(WAKE_LOCK_SUSPEND)) {
 		suspend_sys_sync_abort = true;
+		spin_lock(&suspend_sys_sync_lock);
+		suspend_stats.sync_aborts++;
+		spin_unlock(&suspend_sys_sync_lock);
 		complete(&suspend_sys_sync_comp);
 	} else {
 		mod_timer(&suspend_sys_sync_timer, jiffies +
@@ -381,6 +652,10 @@ static void suspend(struct work_struct *work)
 	getnstimeofday(&ts_entry);
 	ret = pm_suspend(requested_suspend_state);
 	getnstimeofday(&ts_exit);
+#ifdef CONFIG_WAKELOCK_STAT
+	if (!ret)
+		resume_log_add();
+#endif
 
 	if (debug_mask & DEBUG_EXIT_SUSPEND) {
 		struct rtc_time tm;
@@ -433,7 +708,14 @@ static int power_suspend_late(void)
 {
 	int ret = has_wake_lock(WAKE_LOCK_SUSPEND) ? -EAGAIN : 0;
 #ifdef CONFIG_WAKELOCK_STAT
+	unsigned long irqflags;
+
+	spin_lock_irqsave(&list_lock, irqflags);
 	wait_for_wakeup = !ret;
+	resume_irq = -1;
+	resume_source[0] = '\0';
+	resume_log_open = NULL;
+	spin_unlock_irqrestore(&list_lock, irqflags);
 #endif
 	if (debug_mask & DEBUG_SUSPEND)
 		pr_info("power_suspend_late return %d\n", ret);
@@ -468,6 +750,11 @@ void wake_lock_init(struct wake_lock *lock, int type, const char *name)
 
 	INIT_LIST_HEAD(&lock->link);
 	spin_lock_irqsave(&list_lock, irqflags);
+#ifdef CONFIG_WAKELOCK_STAT
+	lock->stat.id = ++wake_lock_next_id;
+	wake_lock_count++;
+	wake_lock_stat_changed(lock);
+#endif
 	list_add(&lock->link, &inactive_locks);
 	spin_unlock_irqrestore(&list_lock, irqflags);
 }
@@ -493,7 +780,10 @@ void wake_lock_destroy(struct wake_lock *lock)
 		deleted_wake_locks.stat.max_time =
 			ktime_add(deleted_wake_locks.stat.max_time,
 				  lock->stat.max_time);
+		wake_lock_stat_changed(&deleted_wake_locks);
 	}
+	wake_lock_removed_locked(lock);
+	wake_lock_count--;
 #endif
 	list_del(&lock->link);
 	spin_unlock_irqrestore(&list_lock, irqflags);
@@ -517,6 +807,7 @@ static void wake_lock_internal(
 			pr_info("wakeup wake lock: %s\n", lock->name);
 		wait_for_wakeup = 0;
 		lock->stat.wakeup_count++;
+		resume_log_attribute_locked(lock);
 	}
 	if ((lock->flags & WAKE_LOCK_AUTO_EXPIRE) &&
 	    (long)(lock->expires - jiffies) <= 0) {
@@ -530,6 +821,9 @@ static void wake_lock_internal(
 		lock->stat.last_time = ktime_get();
 #endif
 	}
+#ifdef CONFIG_WAKELOCK_STAT
+	wake_lock_stat_changed(lock);
+#endif
 	list_del(&lock->link);
 	if (has_timeout) {
 		if (debug_mask & DEBUG_WAKE_LOCK)
@@ -687,6 +981,8 @@ static int __init wakelocks_init(void)
 
 #ifdef CONFIG_WAKELOCK_STAT
 	proc_create("wakelocks", S_IRUGO, NULL, &wakelock_stats_fops);
+	proc_create("wakelocks_bin", S_IRUGO, NULL, &wakelock_bin_fops);
+	proc_create("wakelock_resume", S_IRUGO, NULL, &resume_log_fops);
 #endif
 
 	return 0;
@@ -707,6 +1003,8 @@ err_suspend_work_queue:
 static void  __exit wakelocks_exit(void)
 {
 #ifdef CONFIG_WAKELOCK_STAT
+	remove_proc_entry("wakelock_resume", NULL);
+	remove_proc_entry("wakelocks_bin", NULL);
 	remove_proc_entry("wakelocks", NULL);
 #endif
 	destroy_workqueue(suspend_work_queue);
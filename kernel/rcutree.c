@@ -61,7 +61,7 @@
 
 static struct lock_class_key rcu_node_class[NUM_RCU_LVLS];
 
-#define RCU_STATE_INITIALIZER(structname) { \
+#define RCU_STATE_INITIALIZER(structname, sabbr, cr) { \
 	.level = { &structname##_state.node[0] }, \
 	.levelcnt = { \
 		NUM_RCU_LVL_0,   \
@@ -77,13 +77,17 @@ static struct lock_class_key rcu_node_class[NUM_RCU_LVLS];
 	.fqslock = __RAW_SPIN_LOCK_UNLOCKED(&structname##_state.fqslock), \
 	.n_force_qs = 0, \
 	.n_force_qs_ngp = 0, \
+	.call = cr, \
 	.name = #structname, \
+	.abbr = sabbr, \
 }
 
-struct rcu_state rcu_sched_state = RCU_STATE_INITIALIZER(rcu_sched);
+struct rcu_state rcu_sched_state =
+	RCU_STATE_INITIALIZER(rcu_sched, 's', call_rcu_sched);
 DEFINE_PER_CPU(struct rcu_data, rcu_sched_data);
 
-struct rcu_state rcu_bh_state = RCU_STATE_INITIALIZER(rcu_bh);
+struct rcu_state rcu_bh_state =
+	RCU_STATE_INITIALIZER(rcu_bh, 'b', call_rcu_bh);
 DEFINE_PER_CPU(struct rcu_data, rcu_bh_data);
 
 static struct rcu_state *rcu_state;
@@ -934,6 +938,7 @@ static void rcu_cleanup_dead_cpu(int cpu, struct rcu_state *rsp)
 	
 	rcu_stop_cpu_kthread(cpu);
 	rcu_node_kthread_setaffinity(rnp, -1);
+	do_nocb_deferred_wakeup(rdp);
 
 	
 
@@ -1217,6 +1222,8 @@ __rcu_process_callbacks(struct rcu_state *rsp, struct rcu_data *rdp)
 	
 	if (cpu_has_callbacks_ready_to_invoke(rdp))
 		invoke_rcu_callbacks(rsp, rdp);
+
+	do_nocb_deferred_wakeup(rdp);
 }
 
 static void rcu_process_callbacks(struct softirq_action *unused)
@@ -1262,6 +1269,11 @@ __call_rcu(struct rcu_head *head, void (*func)(struct rcu_head *rcu),
 	local_irq_save(flags);
 	rdp = this_cpu_ptr(rsp->rda);
 
+	if (__call_rcu_nocb(rdp, head, lazy, flags)) {
+		local_irq_restore(flags);
+		return;
+	}
+
 	
 	*rdp->nxttail[RCU_NEXT_TAIL] = head;
 	rdp->nxttail[RCU_NEXT_TAIL] = &head->next;
@@ -1454,6 +1466,10 @@ static int __rcu_pending(struct rcu_state *rsp, struct rcu_data *rdp)
 	}
 
 	
+	if (rcu_nocb_need_deferred_wakeup(rdp))
+		return 1;
+
+	
 	rdp->n_rp_need_nothing++;
 	return 0;
 }
@@ -1470,7 +1486,8 @@ static int rcu_cpu_has_callbacks(int cpu)
 	
 	return per_cpu(rcu_sched_data, cpu).nxtlist ||
 	       per_cpu(rcu_bh_data, cpu).nxtlist ||
-	       rcu_preempt_cpu_has_callbacks(cpu);
+	       rcu_preempt_cpu_has_callbacks(cpu) ||
+	       rcu_nocb_cpu_needs_wakeup(cpu);
 }
 
 static DEFINE_PER_CPU(struct rcu_head, rcu_barrier_head) = {NULL};
@@ -1500,12 +1517,32 @@ static void _rcu_barrier(struct rcu_state *rsp,
 			 void (*call_rcu_func)(struct rcu_head *head,
 					       void (*func)(struct rcu_head *head)))
 {
+	int cpu;
+	unsigned long flags;
+	struct rcu_head *head;
+
 	BUG_ON(in_interrupt());
 	
 	mutex_lock(&rcu_barrier_mutex);
+	get_online_cpus();
 	init_completion(&rcu_barrier_completion);
 	atomic_set(&rcu_barrier_cpu_count, 1);
 	on_each_cpu(rcu_barrier_func, (void *)call_rcu_func, 1);
+
+	
+	for_each_possible_cpu(cpu) {
+		if (cpu_online(cpu) || !rcu_is_nocb_cpu(cpu))
+			continue;
+		head = &per_cpu(rcu_barrier_head, cpu);
+		atomic_inc(&rcu_barrier_cpu_count);
+		debug_rcu_head_queue(head);
+		head->func = rcu_barrier_callback;
+		head->next = NULL;
+		local_irq_save(flags);
+		__call_rcu_nocb(per_cpu_ptr(rsp->rda, cpu), head, 0, flags);
+		local_irq_restore(flags);
+	}
+	put_online_cpus();
 	if (atomic_dec_and_test(&rcu_barrier_cpu_count))
 		complete(&rcu_barrier_completion);
 	wait_for_completion(&rcu_barrier_completion);
@@ -1545,6 +1582,7 @@ rcu_boot_init_percpu_data(int cpu, struct rcu_state *rsp)
 	WARN_ON_ONCE(atomic_read(&rdp->dynticks->dynticks) != 1);
 	rdp->cpu = cpu;
 	rdp->rsp = rsp;
+	rcu_boot_init_nocb_percpu_data(rdp);
 	raw_spin_unlock_irqrestore(&rnp->lock, flags);
 }
 
@@ -1609,6 +1647,7 @@ static int __cpuinit rcu_cpu_notify(struct notifier_block *self,
 	long cpu = (long)hcpu;
 	struct rcu_data *rdp = per_cpu_ptr(rcu_state->rda, cpu);
 	struct rcu_node *rnp = rdp->mynode;
+	int ret = NOTIFY_OK;
 
 	trace_rcu_utilization("Start CPU hotplug");
 	switch (action) {
@@ -1623,6 +1662,10 @@ static int __cpuinit rcu_cpu_notify(struct notifier_block *self,
 		rcu_cpu_kthread_setrt(cpu, 1);
 		break;
 	case CPU_DOWN_PREPARE:
+		if (!rcu_nocb_cpu_expendable(cpu)) {
+			ret = NOTIFY_BAD;
+			break;
+		}
 		rcu_node_kthread_setaffinity(rnp, cpu);
 		rcu_cpu_kthread_setrt(cpu, 0);
 		break;
@@ -1645,7 +1688,7 @@ static int __cpuinit rcu_cpu_notify(struct notifier_block *self,
 		break;
 	}
 	trace_rcu_utilization("End CPU hotplug");
-	return NOTIFY_OK;
+	return ret;
 }
 
 void rcu_scheduler_starting(void)
@@ -249,6 +249,20 @@ struct rcu_data {
 	unsigned long n_rp_need_fqs;
 	unsigned long n_rp_need_nothing;
 
+#ifdef CONFIG_RCU_NOCB_CPU
+	struct rcu_head *nocb_head;
+	struct rcu_head **nocb_tail;
+	atomic_long_t nocb_q_count;
+	atomic_long_t nocb_q_count_lazy;
+	long nocb_p_count;
+	long nocb_p_count_lazy;
+	bool nocb_defer_wakeup;
+	struct task_struct *nocb_kthread;
+	unsigned long n_nocbs_invoked;
+	unsigned long n_nocb_gps;
+	unsigned long nocb_max_per_gp;
+#endif
+
 	int cpu;
 	struct rcu_state *rsp;
 };
@@ -324,7 +338,10 @@ struct rcu_state {
 						
 	unsigned long gp_max;			
 						
+	void (*call)(struct rcu_head *head,	
+		     void (*func)(struct rcu_head *head));
 	char *name;				
+	char abbr;				
 };
 
 
@@ -408,5 +425,13 @@ static void print_cpu_stall_info(struct rcu_state *rsp, int cpu);
 static void print_cpu_stall_info_end(void);
 static void zero_cpu_stall_ticks(struct rcu_data *rdp);
 static void increment_cpu_stall_ticks(void);
+static bool rcu_is_nocb_cpu(int cpu);
+static bool __call_rcu_nocb(struct rcu_data *rdp, struct rcu_head *rhp,
+			    bool lazy, unsigned long flags);
+static bool rcu_nocb_need_deferred_wakeup(struct rcu_data *rdp);
+static void do_nocb_deferred_wakeup(struct rcu_data *rdp);
+static int rcu_nocb_cpu_needs_wakeup(int cpu);
+static bool rcu_nocb_cpu_expendable(int cpu);
+static void rcu_boot_init_nocb_percpu_data(struct rcu_data *rdp);
 
 #endif 
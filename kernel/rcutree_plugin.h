@@ -34,6 +34,12 @@
 #define RCU_BOOST_PRIO RCU_KTHREAD_PRIO
 #endif
 
+#ifdef CONFIG_RCU_NOCB_CPU
+static cpumask_var_t rcu_nocb_mask;
+static bool have_rcu_nocb_mask;
+static char __initdata nocb_buf[NR_CPUS * 5];
+#endif
+
 static void __init rcu_bootup_announce_oddness(void)
 {
 #ifdef CONFIG_RCU_TRACE
@@ -65,11 +71,23 @@ static void __init rcu_bootup_announce_oddness(void)
 #if NUM_RCU_LVL_4 != 0
 	printk(KERN_INFO "\tExperimental four-level hierarchy is enabled.\n");
 #endif
+#ifdef CONFIG_RCU_NOCB_CPU
+	if (have_rcu_nocb_mask) {
+		if (cpumask_test_cpu(0, rcu_nocb_mask)) {
+			cpumask_clear_cpu(0, rcu_nocb_mask);
+			printk(KERN_INFO "\tCPU 0: illegal no-CBs CPU (cleared).\n");
+		}
+		cpulist_scnprintf(nocb_buf, sizeof(nocb_buf), rcu_nocb_mask);
+		printk(KERN_INFO "\tOffloaded RCU callbacks from CPUs: %s.\n",
+		       nocb_buf);
+	}
+#endif
 }
 
 #ifdef CONFIG_TREE_PREEMPT_RCU
 
-struct rcu_state rcu_preempt_state = RCU_STATE_INITIALIZER(rcu_preempt);
+struct rcu_state rcu_preempt_state =
+	RCU_STATE_INITIALIZER(rcu_preempt, 'p', call_rcu);
 DEFINE_PER_CPU(struct rcu_data, rcu_preempt_data);
 static struct rcu_state *rcu_state = &rcu_preempt_state;
 
@@ -1649,3 +1667,257 @@ static void increment_cpu_stall_ticks(void)
 }
 
 #endif 
+
+#ifdef CONFIG_RCU_NOCB_CPU
+
+/*
+ * Callbacks queued on a CPU in rcu_nocbs= go to a lockless per-CPU list
+ * instead of ->nxtlist.  An "rcuo" kthread running on one of the other
+ * CPUs gathers them for nocb_batch_ms, waits for a single grace period
+ * on behalf of the whole batch and then invokes them, so the offloaded
+ * CPU neither runs RCU_SOFTIRQ callback work nor keeps its tick for it.
+ */
+static int nocb_batch_ms = 20;
+module_param(nocb_batch_ms, int, 0644);
+
+static int __init rcu_nocb_setup(char *str)
+{
+	alloc_bootmem_cpumask_var(&rcu_nocb_mask);
+	have_rcu_nocb_mask = true;
+	cpulist_parse(str, rcu_nocb_mask);
+	return 1;
+}
+__setup("rcu_nocbs=", rcu_nocb_setup);
+
+static bool rcu_is_nocb_cpu(int cpu)
+{
+	if (have_rcu_nocb_mask)
+		return cpumask_test_cpu(cpu, rcu_nocb_mask);
+	return false;
+}
+
+/*
+ * The caller has interrupts disabled.  If they were already disabled on
+ * entry to call_rcu(), the caller may hold scheduler locks, so the
+ * kthread is woken later from RCU_SOFTIRQ instead.
+ */
+static bool __call_rcu_nocb(struct rcu_data *rdp, struct rcu_head *rhp,
+			    bool lazy, unsigned long flags)
+{
+	struct rcu_head **old_rhpp;
+	struct task_struct *t;
+	long len;
+
+	if (!rcu_is_nocb_cpu(rdp->cpu))
+		return false;
+
+	old_rhpp = xchg(&rdp->nocb_tail, &rhp->next);
+	ACCESS_ONCE(*old_rhpp) = rhp;
+	len = atomic_long_inc_return(&rdp->nocb_q_count);
+	if (lazy)
+		atomic_long_inc(&rdp->nocb_q_count_lazy);
+
+	if (__is_kfree_rcu_offset((unsigned long)rhp->func))
+		trace_rcu_kfree_callback(rdp->rsp->name, rhp,
+					 (unsigned long)rhp->func,
+					 atomic_long_read(&rdp->nocb_q_count_lazy),
+					 len);
+	else
+		trace_rcu_callback(rdp->rsp->name, rhp,
+				   atomic_long_read(&rdp->nocb_q_count_lazy),
+				   len);
+
+	
+	t = ACCESS_ONCE(rdp->nocb_kthread);
+	if (!t)
+		return true;
+	if (old_rhpp != &rdp->nocb_head && len != qhimark)
+		return true;
+	if (irqs_disabled_flags(flags))
+		ACCESS_ONCE(rdp->nocb_defer_wakeup) = true;
+	else
+		wake_up_process(t);
+	return true;
+}
+
+static bool rcu_nocb_need_deferred_wakeup(struct rcu_data *rdp)
+{
+	return ACCESS_ONCE(rdp->nocb_defer_wakeup);
+}
+
+static void do_nocb_deferred_wakeup(struct rcu_data *rdp)
+{
+	if (!rcu_nocb_need_deferred_wakeup(rdp))
+		return;
+	ACCESS_ONCE(rdp->nocb_defer_wakeup) = false;
+	wake_up_process(rdp->nocb_kthread);
+}
+
+static int rcu_nocb_cpu_needs_wakeup(int cpu)
+{
+	if (!rcu_is_nocb_cpu(cpu))
+		return 0;
+#ifdef CONFIG_TREE_PREEMPT_RCU
+	if (rcu_nocb_need_deferred_wakeup(&per_cpu(rcu_preempt_data, cpu)))
+		return 1;
+#endif
+	return rcu_nocb_need_deferred_wakeup(&per_cpu(rcu_sched_data, cpu)) ||
+	       rcu_nocb_need_deferred_wakeup(&per_cpu(rcu_bh_data, cpu));
+}
+
+/*
+ * The rcuo kthreads wait for grace periods through callbacks queued on
+ * the CPU they run on, so that CPU must not be offloaded itself.  Refuse
+ * to take down the last CPU that is left to run them.
+ */
+static bool rcu_nocb_cpu_expendable(int cpu)
+{
+	int i;
+
+	if (!have_rcu_nocb_mask || cpumask_empty(rcu_nocb_mask) ||
+	    rcu_is_nocb_cpu(cpu))
+		return true;
+	for_each_online_cpu(i)
+		if (i != cpu && !rcu_is_nocb_cpu(i))
+			return true;
+	return false;
+}
+
+static int rcu_nocb_kthread(void *arg)
+{
+	long c, cl;
+	int delay;
+	struct rcu_head *list;
+	struct rcu_head *next;
+	struct rcu_head **tail;
+	struct rcu_data *rdp = arg;
+
+	for (;;) {
+		rcu_wait(ACCESS_ONCE(rdp->nocb_head));
+
+		
+		delay = ACCESS_ONCE(nocb_batch_ms);
+		if (delay > 0 && atomic_long_read(&rdp->nocb_q_count) < qhimark)
+			schedule_timeout_interruptible(msecs_to_jiffies(delay));
+
+		
+		list = ACCESS_ONCE(rdp->nocb_head);
+		ACCESS_ONCE(rdp->nocb_head) = NULL;
+		tail = xchg(&rdp->nocb_tail, &rdp->nocb_head);
+		c = atomic_long_xchg(&rdp->nocb_q_count, 0);
+		cl = atomic_long_xchg(&rdp->nocb_q_count_lazy, 0);
+		ACCESS_ONCE(rdp->nocb_p_count) += c;
+		ACCESS_ONCE(rdp->nocb_p_count_lazy) += cl;
+		wait_rcu_gp(rdp->rsp->call);
+		rdp->n_nocb_gps++;
+
+		
+		trace_rcu_batch_start(rdp->rsp->name, cl, c, -1);
+		c = cl = 0;
+		while (list) {
+			next = list->next;
+			
+			while (next == NULL && &list->next != tail) {
+				schedule_timeout_interruptible(1);
+				next = list->next;
+			}
+			debug_rcu_head_unqueue(list);
+			local_bh_disable();
+			if (__rcu_reclaim(rdp->rsp->name, list))
+				cl++;
+			c++;
+			local_bh_enable();
+			list = next;
+		}
+		trace_rcu_batch_end(rdp->rsp->name, c, !!list, 0, 0, 1);
+		ACCESS_ONCE(rdp->nocb_p_count) -= c;
+		ACCESS_ONCE(rdp->nocb_p_count_lazy) -= cl;
+		rdp->n_nocbs_invoked += c;
+		if (c > rdp->nocb_max_per_gp)
+			rdp->nocb_max_per_gp = c;
+	}
+	return 0;
+}
+
+static void rcu_boot_init_nocb_percpu_data(struct rcu_data *rdp)
+{
+	rdp->nocb_tail = &rdp->nocb_head;
+}
+
+static void __init rcu_spawn_nocb_kthreads(struct rcu_state *rsp,
+					   const struct cpumask *cm)
+{
+	int cpu;
+	struct rcu_data *rdp;
+	struct task_struct *t;
+
+	for_each_cpu(cpu, rcu_nocb_mask) {
+		rdp = per_cpu_ptr(rsp->rda, cpu);
+		t = kthread_create(rcu_nocb_kthread, rdp,
+				   "rcuo%c/%d", rsp->abbr, cpu);
+		BUG_ON(IS_ERR(t));
+		set_cpus_allowed_ptr(t, cm);
+		ACCESS_ONCE(rdp->nocb_kthread) = t;
+		wake_up_process(t);
+	}
+}
+
+static int __init rcu_spawn_all_nocb_kthreads(void)
+{
+	cpumask_var_t cm;
+
+	if (!have_rcu_nocb_mask)
+		return 0;
+	cpumask_and(rcu_nocb_mask, rcu_nocb_mask, cpu_possible_mask);
+	if (cpumask_empty(rcu_nocb_mask))
+		return 0;
+	if (!zalloc_cpumask_var(&cm, GFP_KERNEL))
+		return -ENOMEM;
+	cpumask_andnot(cm, cpu_possible_mask, rcu_nocb_mask);
+#ifdef CONFIG_TREE_PREEMPT_RCU
+	rcu_spawn_nocb_kthreads(&rcu_preempt_state, cm);
+#endif
+	rcu_spawn_nocb_kthreads(&rcu_sched_state, cm);
+	rcu_spawn_nocb_kthreads(&rcu_bh_state, cm);
+	free_cpumask_var(cm);
+	return 0;
+}
+early_initcall(rcu_spawn_all_nocb_kthreads);
+
+#else 
+
+static bool rcu_is_nocb_cpu(int cpu)
+{
+	return false;
+}
+
+static bool __call_rcu_nocb(struct rcu_data *rdp, struct rcu_head *rhp,
+			    bool lazy, unsigned long flags)
+{
+	return false;
+}
+
+static bool rcu_nocb_need_deferred_wakeup(struct rcu_data *rdp)
+{
+	return false;
+}
+
+static void do_nocb_deferred_wakeup(struct rcu_data *rdp)
+{
+}
+
+static int rcu_nocb_cpu_needs_wakeup(int cpu)
+{
+	return 0;
+}
+
+static bool rcu_nocb_cpu_expendable(int cpu)
+{
+	return true;
+}
+
+static void rcu_boot_init_nocb_percpu_data(struct rcu_data *rdp)
+{
+}
+
+#endif 
@@ -91,8 +91,21 @@ static void print_one_rcu_data(struct seq_file *m, struct rcu_data *rdp)
 		   per_cpu(rcu_cpu_kthread_loops, rdp->cpu) & 0xffff);
 #endif /* #ifdef CONFIG_RCU_BOOST */
 	seq_printf(m, " b=%ld", rdp->blimit);
-	seq_printf(m, " ci=%lu co=%lu ca=%lu\n",
+	seq_printf(m, " ci=%lu co=%lu ca=%lu",
 		   rdp->n_cbs_invoked, rdp->n_cbs_orphaned, rdp->n_cbs_adopted);
+#ifdef CONFIG_RCU_NOCB_CPU
+	if (rdp->nocb_kthread)
+		seq_printf(m, " nq=%ld/%ld nci=%lu ngp=%lu cpg=%lu/%lu",
+			   atomic_long_read(&rdp->nocb_q_count_lazy) +
+			   rdp->nocb_p_count_lazy,
+			   atomic_long_read(&rdp->nocb_q_count) +
+			   rdp->nocb_p_count,
+			   rdp->n_nocbs_invoked, rdp->n_nocb_gps,
+			   rdp->n_nocb_gps ?
+			   rdp->n_nocbs_invoked / rdp->n_nocb_gps : 0,
+			   rdp->nocb_max_per_gp);
+#endif /* #ifdef CONFIG_RCU_NOCB_CPU */
+	seq_putc(m, '\n');
 }
 
 #define PRINT_RCU_DATA(name, func, m) \
@@ -26,6 +26,8 @@
 #include <linux/slab.h>
 #include <linux/profile.h>
 #include <linux/interrupt.h>
+#include <linux/cpuidle.h>
+#include <linux/export.h>
 
 #include <trace/events/sched.h>
 
@@ -883,6 +885,351 @@ place_entity(struct cfs_rq *cfs_rq, struct sched_entity *se, int initial)
 	se->vruntime = vruntime;
 }
 
+#ifdef CONFIG_SMP
+/*
+ * Per-entity load tracking: runnable time is accumulated in ~1ms periods
+ * and geometrically decayed so that a period 32ms ago carries half the
+ * weight of the current one.
+ */
+#define LOAD_AVG_PERIOD 32
+#define LOAD_AVG_MAX 47742
+#define LOAD_AVG_MAX_N 345
+
+static const u32 runnable_avg_yN_inv[] = {
+	0xffffffff, 0xfa83b2da, 0xf5257d14, 0xefe4b99a, 0xeac0c6e6, 0xe5b906e6,
+	0xe0ccdeeb, 0xdbfbb796, 0xd744fcc9, 0xd2a81d91, 0xce248c14, 0xc9b9bd85,
+	0xc5672a10, 0xc12c4cc9, 0xbd08a39e, 0xb8fbaf46, 0xb504f333, 0xb123f581,
+	0xad583ee9, 0xa9a15ab4, 0xa5fed6a9, 0xa2704302, 0x9ef5325f, 0x9b8d39b9,
+	0x9837f050, 0x94f4efa8, 0x91c3d373, 0x8ea4398a, 0x8b95c1e3, 0x88980e80,
+	0x85aac367, 0x82cd8698,
+};
+
+static const u32 runnable_avg_yN_sum[] = {
+	    0, 1002, 1982, 2941, 3880, 4798, 5697, 6576, 7437, 8279, 9103,
+	 9909,10698,11470,12226,12966,13690,14398,15091,15769,16433,17082,
+	17718,18340,18949,19545,20128,20698,21256,21802,22336,22859,23371,
+};
+
+static __always_inline u64 decay_load(u64 val, u64 n)
+{
+	unsigned int local_n;
+
+	if (!n)
+		return val;
+	else if (unlikely(n > LOAD_AVG_PERIOD * 63))
+		return 0;
+
+	local_n = n;
+
+	if (unlikely(local_n >= LOAD_AVG_PERIOD)) {
+		val >>= local_n / LOAD_AVG_PERIOD;
+		local_n %= LOAD_AVG_PERIOD;
+	}
+
+	val *= runnable_avg_yN_inv[local_n];
+	return val >> 32;
+}
+
+static u32 __compute_runnable_contrib(u64 n)
+{
+	u32 contrib = 0;
+
+	if (likely(n <= LOAD_AVG_PERIOD))
+		return runnable_avg_yN_sum[n];
+	else if (unlikely(n >= LOAD_AVG_MAX_N))
+		return LOAD_AVG_MAX;
+
+	do {
+		contrib /= 2;
+		contrib += runnable_avg_yN_sum[LOAD_AVG_PERIOD];
+
+		n -= LOAD_AVG_PERIOD;
+	} while (n > LOAD_AVG_PERIOD);
+
+	contrib = decay_load(contrib, n);
+	return contrib + runnable_avg_yN_sum[n];
+}
+
+static __always_inline int __update_entity_runnable_avg(u64 now,
+							struct sched_avg *sa,
+							int runnable)
+{
+	u64 delta, periods;
+	u32 runnable_contrib;
+	int delta_w, decayed = 0;
+
+	delta = now - sa->last_runnable_update;
+	if ((s64)delta < 0) {
+		sa->last_runnable_update = now;
+		return 0;
+	}
+
+	delta >>= 10;
+	if (!delta)
+		return 0;
+	sa->last_runnable_update = now;
+
+	delta_w = sa->runnable_avg_period % 1024;
+	if (delta + delta_w >= 1024) {
+		decayed = 1;
+
+		delta_w = 1024 - delta_w;
+		if (runnable)
+			sa->runnable_avg_sum += delta_w;
+		sa->runnable_avg_period += delta_w;
+
+		delta -= delta_w;
+
+		periods = div_u64(delta, 1024);
+		delta %= 1024;
+
+		sa->runnable_avg_sum = decay_load(sa->runnable_avg_sum,
+						  periods + 1);
+		sa->runnable_avg_period = decay_load(sa->runnable_avg_period,
+						     periods + 1);
+
+		runnable_contrib = __compute_runnable_contrib(periods);
+		if (runnable)
+			sa->runnable_avg_sum += runnable_contrib;
+		sa->runnable_avg_period += runnable_contrib;
+	}
+
+	if (runnable)
+		sa->runnable_avg_sum += delta;
+	sa->runnable_avg_period += delta;
+
+	return decayed;
+}
+
+static inline u64 __synchronize_entity_decay(struct sched_entity *se)
+{
+	struct cfs_rq *cfs_rq = cfs_rq_of(se);
+	u64 decays = atomic64_read(&cfs_rq->decay_counter);
+
+	decays -= se->avg.decay_count;
+	if (!decays)
+		return 0;
+
+	se->avg.load_avg_contrib = decay_load(se->avg.load_avg_contrib, decays);
+	se->avg.decay_count = 0;
+
+	return decays;
+}
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+static inline void __update_cfs_rq_tg_load_contrib(struct cfs_rq *cfs_rq,
+						   int force_update)
+{
+	struct task_group *tg = cfs_rq->tg;
+	s64 tg_contrib;
+
+	tg_contrib = cfs_rq->runnable_load_avg + cfs_rq->blocked_load_avg;
+	tg_contrib -= cfs_rq->tg_load_contrib;
+
+	if (force_update || abs64(tg_contrib) > cfs_rq->tg_load_contrib / 8) {
+		atomic64_add(tg_contrib, &tg->load_avg);
+		cfs_rq->tg_load_contrib += tg_contrib;
+	}
+}
+
+static inline void __update_tg_runnable_avg(struct sched_avg *sa,
+					    struct cfs_rq *cfs_rq)
+{
+	struct task_group *tg = cfs_rq->tg;
+	long contrib;
+
+	contrib = div_u64((u64)sa->runnable_avg_sum << NICE_0_SHIFT,
+			  sa->runnable_avg_period + 1);
+	contrib -= cfs_rq->tg_runnable_contrib;
+
+	if (abs(contrib) > cfs_rq->tg_runnable_contrib / 64) {
+		atomic_add(contrib, &tg->runnable_avg);
+		cfs_rq->tg_runnable_contrib += contrib;
+	}
+}
+
+static inline void __update_group_entity_contrib(struct sched_entity *se)
+{
+	struct cfs_rq *cfs_rq = group_cfs_rq(se);
+	struct task_group *tg = cfs_rq->tg;
+	int runnable_avg;
+	u64 contrib;
+
+	contrib = cfs_rq->tg_load_contrib * tg->shares;
+	se->avg.load_avg_contrib = div64_u64(contrib,
+					     atomic64_read(&tg->load_avg) + 1);
+
+	/*
+	 * A group using less than one cpu in total should contribute the
+	 * same load as a task of equal weight; the sum of the per-cpu
+	 * runnable averages is a usable lower bound for that fraction.
+	 */
+	runnable_avg = atomic_read(&tg->runnable_avg);
+	if (runnable_avg < NICE_0_LOAD) {
+		se->avg.load_avg_contrib *= runnable_avg;
+		se->avg.load_avg_contrib >>= NICE_0_SHIFT;
+	}
+}
+#else
+static inline void __update_cfs_rq_tg_load_contrib(struct cfs_rq *cfs_rq,
+						   int force_update) {}
+static inline void __update_tg_runnable_avg(struct sched_avg *sa,
+					    struct cfs_rq *cfs_rq) {}
+static inline void __update_group_entity_contrib(struct sched_entity *se) {}
+#endif
+
+static inline void __update_task_entity_contrib(struct sched_entity *se)
+{
+	u32 contrib;
+
+	contrib = se->avg.runnable_avg_sum * scale_load_down(se->load.weight);
+	contrib /= (se->avg.runnable_avg_period + 1);
+	se->avg.load_avg_contrib = scale_load(contrib);
+}
+
+static long __update_entity_load_avg_contrib(struct sched_entity *se)
+{
+	long old_contrib = se->avg.load_avg_contrib;
+
+	if (entity_is_task(se)) {
+		__update_task_entity_contrib(se);
+	} else {
+		__update_tg_runnable_avg(&se->avg, group_cfs_rq(se));
+		__update_group_entity_contrib(se);
+	}
+
+	return se->avg.load_avg_contrib - old_contrib;
+}
+
+static inline void subtract_blocked_load_contrib(struct cfs_rq *cfs_rq,
+						 long load_contrib)
+{
+	if (likely(load_contrib < cfs_rq->blocked_load_avg))
+		cfs_rq->blocked_load_avg -= load_contrib;
+	else
+		cfs_rq->blocked_load_avg = 0;
+}
+
+static inline void update_entity_load_avg(struct sched_entity *se,
+					  int update_cfs_rq)
+{
+	struct cfs_rq *cfs_rq = cfs_rq_of(se);
+	long contrib_delta;
+
+	if (!__update_entity_runnable_avg(rq_of(cfs_rq)->clock_task, &se->avg,
+					  se->on_rq))
+		return;
+
+	contrib_delta = __update_entity_load_avg_contrib(se);
+
+	if (!update_cfs_rq)
+		return;
+
+	if (se->on_rq)
+		cfs_rq->runnable_load_avg += contrib_delta;
+	else
+		subtract_blocked_load_contrib(cfs_rq, -contrib_delta);
+}
+
+static void update_cfs_rq_blocked_load(struct cfs_rq *cfs_rq, int force_update)
+{
+	u64 now = rq_of(cfs_rq)->clock_task >> 20;
+	u64 decays;
+
+	decays = now - cfs_rq->last_decay;
+	if (!decays && !force_update)
+		return;
+
+	if (atomic64_read(&cfs_rq->removed_load)) {
+		u64 removed_load = atomic64_xchg(&cfs_rq->removed_load, 0);
+		subtract_blocked_load_contrib(cfs_rq, removed_load);
+	}
+
+	if (decays) {
+		cfs_rq->blocked_load_avg = decay_load(cfs_rq->blocked_load_avg,
+						      decays);
+		atomic64_add(decays, &cfs_rq->decay_counter);
+		cfs_rq->last_decay = now;
+	}
+
+	__update_cfs_rq_tg_load_contrib(cfs_rq, force_update);
+}
+
+static inline void update_rq_runnable_avg(struct rq *rq, int runnable)
+{
+	__update_entity_runnable_avg(rq->clock_task, &rq->avg, runnable);
+	__update_tg_runnable_avg(&rq->avg, &rq->cfs);
+}
+
+static inline void enqueue_entity_load_avg(struct cfs_rq *cfs_rq,
+					   struct sched_entity *se,
+					   int wakeup)
+{
+	/*
+	 * A decay_count <= 0 marks a new or migrated entity; after a wakeup
+	 * migration it holds the negated number of decays accrued while
+	 * sleeping on the old cpu, since the clocks cannot be compared.
+	 */
+	if (unlikely(se->avg.decay_count <= 0)) {
+		se->avg.last_runnable_update = rq_of(cfs_rq)->clock_task;
+		if (se->avg.decay_count) {
+			se->avg.last_runnable_update -= (-se->avg.decay_count)
+							<< 20;
+			update_entity_load_avg(se, 0);
+			se->avg.decay_count = 0;
+		}
+		wakeup = 0;
+	} else {
+		__synchronize_entity_decay(se);
+	}
+
+	if (wakeup) {
+		subtract_blocked_load_contrib(cfs_rq, se->avg.load_avg_contrib);
+		update_entity_load_avg(se, 0);
+	}
+
+	cfs_rq->runnable_load_avg += se->avg.load_avg_contrib;
+	update_cfs_rq_blocked_load(cfs_rq, !wakeup);
+}
+
+static inline void dequeue_entity_load_avg(struct cfs_rq *cfs_rq,
+					   struct sched_entity *se,
+					   int sleep)
+{
+	update_entity_load_avg(se, 1);
+	update_cfs_rq_blocked_load(cfs_rq, !sleep);
+
+	cfs_rq->runnable_load_avg -= se->avg.load_avg_contrib;
+	if (sleep) {
+		cfs_rq->blocked_load_avg += se->avg.load_avg_contrib;
+		se->avg.decay_count = atomic64_read(&cfs_rq->decay_counter);
+	}
+}
+
+void init_task_runnable_average(struct task_struct *p)
+{
+	u32 slice;
+
+	p->se.avg.decay_count = 0;
+	slice = sched_slice(task_cfs_rq(p), &p->se) >> 10;
+	p->se.avg.runnable_avg_sum = slice;
+	p->se.avg.runnable_avg_period = slice;
+	__update_task_entity_contrib(&p->se);
+}
+#else
+static inline void update_entity_load_avg(struct sched_entity *se,
+					  int update_cfs_rq) {}
+static inline void update_rq_runnable_avg(struct rq *rq, int runnable) {}
+static inline void enqueue_entity_load_avg(struct cfs_rq *cfs_rq,
+					   struct sched_entity *se,
+					   int wakeup) {}
+static inline void dequeue_entity_load_avg(struct cfs_rq *cfs_rq,
+					   struct sched_entity *se,
+					   int sleep) {}
+static inline void update_cfs_rq_blocked_load(struct cfs_rq *cfs_rq,
+					      int force_update) {}
+#endif
+
 static void check_enqueue_throttle(struct cfs_rq *cfs_rq);
 
 static void
@@ -892,6 +1239,7 @@ enqueue_entity(struct cfs_rq *cfs_rq, struct sched_entity *se, int flags)
 		se->vruntime += cfs_rq->min_vruntime;
 
 	update_curr(cfs_rq);
+	enqueue_entity_load_avg(cfs_rq, se, flags & ENQUEUE_WAKEUP);
 	update_cfs_load(cfs_rq, 0);
 	account_entity_enqueue(cfs_rq, se);
 	update_cfs_shares(cfs_rq);
@@ -964,6 +1312,7 @@ static void
 dequeue_entity(struct cfs_rq *cfs_rq, struct sched_entity *se, int flags)
 {
 	update_curr(cfs_rq);
+	dequeue_entity_load_avg(cfs_rq, se, flags & DEQUEUE_SLEEP);
 
 	update_stats_dequeue(cfs_rq, se);
 	if (flags & DEQUEUE_SLEEP) {
@@ -997,10 +1346,33 @@ dequeue_entity(struct cfs_rq *cfs_rq, struct sched_entity *se, int flags)
 	update_cfs_shares(cfs_rq);
 }
 
+/*
+ * Entities in (or below) a cpu cgroup with ui_boost set preempt unboosted
+ * ones on wakeup and cut their minimum run time short when waiting.
+ */
+#define UI_BOOST_GRAN_SHIFT	2
+
+#ifdef CONFIG_FAIR_GROUP_SCHED
+static inline int entity_ui_boosted(struct sched_entity *se)
+{
+	struct task_group *tg = se->my_q ? se->my_q->tg : cfs_rq_of(se)->tg;
+
+	for (; tg; tg = tg->parent)
+		if (tg->ui_boost)
+			return 1;
+	return 0;
+}
+#else
+static inline int entity_ui_boosted(struct sched_entity *se)
+{
+	return 0;
+}
+#endif
+
 static void
 check_preempt_tick(struct cfs_rq *cfs_rq, struct sched_entity *curr)
 {
-	unsigned long ideal_runtime, delta_exec;
+	unsigned long ideal_runtime, delta_exec, min_gran;
 	struct sched_entity *se;
 	s64 delta;
 
@@ -1012,10 +1384,14 @@ check_preempt_tick(struct cfs_rq *cfs_rq, struct sched_entity *curr)
 		return;
 	}
 
-	if (delta_exec < sysctl_sched_min_granularity)
+	se = __pick_first_entity(cfs_rq);
+	min_gran = sysctl_sched_min_granularity;
+	if (entity_ui_boosted(se) && !entity_ui_boosted(curr))
+		min_gran >>= UI_BOOST_GRAN_SHIFT;
+
+	if (delta_exec < min_gran)
 		return;
 
-	se = __pick_first_entity(cfs_rq);
 	delta = curr->vruntime - se->vruntime;
 
 	if (delta < 0)
@@ -1032,6 +1408,7 @@ set_next_entity(struct cfs_rq *cfs_rq, struct sched_entity *se)
 	if (se->on_rq) {
 		update_stats_wait_end(cfs_rq, se);
 		__dequeue_entity(cfs_rq, se);
+		update_entity_load_avg(se, 1);
 	}
 
 	update_stats_curr_start(cfs_rq, se);
@@ -1121,6 +1498,7 @@ static void put_prev_entity(struct cfs_rq *cfs_rq, struct sched_entity *prev)
 		update_stats_wait_start(cfs_rq, prev);
 		
 		__enqueue_entity(cfs_rq, prev);
+		update_entity_load_avg(prev, 1);
 	}
 	cfs_rq->curr = NULL;
 }
@@ -1130,6 +1508,9 @@ entity_tick(struct cfs_rq *cfs_rq, struct sched_entity *curr, int queued)
 {
 	update_curr(cfs_rq);
 
+	update_entity_load_avg(curr, 1);
+	update_cfs_rq_blocked_load(cfs_rq, 1);
+
 	update_entity_shares_tick(cfs_rq);
 
 #ifdef CONFIG_SCHED_HRTICK
@@ -1877,10 +2258,13 @@ enqueue_task_fair(struct rq *rq, struct task_struct *p, int flags)
 
 		update_cfs_load(cfs_rq, 0);
 		update_cfs_shares(cfs_rq);
+		update_entity_load_avg(se, 1);
 	}
 
-	if (!se)
+	if (!se) {
+		update_rq_runnable_avg(rq, rq->nr_running);
 		inc_nr_running(rq);
+	}
 	hrtick_update(rq);
 }
 
@@ -1921,16 +2305,20 @@ static void dequeue_task_fair(struct rq *rq, struct task_struct *p, int flags)
 
 		update_cfs_load(cfs_rq, 0);
 		update_cfs_shares(cfs_rq);
+		update_entity_load_avg(se, 1);
 	}
 
 	if (!se)
 		dec_nr_running(rq);
+	update_rq_runnable_avg(rq, 1);
 	hrtick_update(rq);
 }
 
 #ifdef CONFIG_SMP
 static unsigned long weighted_cpuload(const int cpu)
 {
+	if (sched_feat(LB_RUNNABLE_AVG))
+		return cpu_rq(cpu)->cfs.runnable_load_avg;
 	return cpu_rq(cpu)->load.weight;
 }
 
@@ -1967,7 +2355,7 @@ static unsigned long cpu_avg_load_per_task(int cpu)
 	unsigned long nr_running = ACCESS_ONCE(rq->nr_running);
 
 	if (nr_running)
-		return rq->load.weight / nr_running;
+		return weighted_cpuload(cpu) / nr_running;
 
 	return 0;
 }
@@ -1994,6 +2382,22 @@ static void task_waking_fair(struct task_struct *p)
 	se->vruntime -= min_vruntime;
 }
 
+static void migrate_task_rq_fair(struct task_struct *p, int next_cpu)
+{
+	struct sched_entity *se = &p->se;
+	struct cfs_rq *cfs_rq = cfs_rq_of(se);
+
+	/*
+	 * The blocked contribution is pulled off the old cfs_rq lazily, as
+	 * its rq lock is not held here; the decays accrued so far are kept
+	 * negated so the entity can be aged on enqueue at the new cpu.
+	 */
+	if (se->avg.decay_count) {
+		se->avg.decay_count = -__synchronize_entity_decay(se);
+		atomic64_add(se->avg.load_avg_contrib, &cfs_rq->removed_load);
+	}
+}
+
 #ifdef CONFIG_FAIR_GROUP_SCHED
 static long effective_load(struct task_group *tg, int cpu, long wl, long wg)
 {
@@ -2208,6 +2612,147 @@ done:
 	return target;
 }
 
+/*
+ * Energy aware wakeup: place small tasks where their last burst costs the
+ * least energy according to the platform model, packing onto running cpus
+ * until ENERGY_CAPACITY_PCT of their power is used.
+ */
+#define ENERGY_SMALL_TASK_LOAD	(NICE_0_LOAD / 4)
+#define ENERGY_CAPACITY_PCT	80
+
+enum {
+	ENERGY_PLACE_PACK,
+	ENERGY_PLACE_WAKE_IDLE,
+	ENERGY_PLACE_BIG_TASK,
+	ENERGY_PLACE_NO_CAPACITY,
+};
+
+static const struct sched_energy_model __rcu *sched_energy;
+
+void sched_set_energy_model(const struct sched_energy_model *model)
+{
+	const struct sched_energy_model *old = rcu_dereference_protected(
+						sched_energy, 1);
+
+	rcu_assign_pointer(sched_energy, model);
+	if (old)
+		synchronize_rcu();
+}
+
+static unsigned long energy_task_load(struct task_struct *p)
+{
+	return p->se.avg.load_avg_contrib;
+}
+
+static bool energy_cpu_fits(int cpu, unsigned long load)
+{
+	return cpu_rq(cpu)->cfs.runnable_load_avg + load <=
+		power_of(cpu) * ENERGY_CAPACITY_PCT / 100;
+}
+
+/*
+ * Keep a packed small task where it is while its cpu has headroom, so
+ * that periodic and idle balancing do not spread it out again.
+ */
+static bool energy_keep_packed(struct task_struct *p, int cpu)
+{
+	return sched_feat(ENERGY_AWARE) && rcu_access_pointer(sched_energy) &&
+	       energy_task_load(p) <= ENERGY_SMALL_TASK_LOAD &&
+	       energy_cpu_fits(cpu, 0);
+}
+
+static unsigned long energy_power_at(const struct sched_energy_model *em,
+				     unsigned long freq)
+{
+	int i;
+
+	for (i = 0; i < em->nr_states - 1; i++)
+		if (em->states[i].freq >= freq)
+			break;
+
+	return em->states[i].power;
+}
+
+static unsigned long energy_run_cost(const struct sched_energy_model *em,
+				     int cpu, u64 work)
+{
+	unsigned long freq = em->cur_freq(cpu);
+
+	if (!freq)
+		freq = em->states[em->nr_states - 1].freq;
+
+	return div_u64(work * energy_power_at(em, freq), freq);
+}
+
+static int energy_aware_cpu(struct task_struct *p, int prev_cpu)
+{
+	const struct sched_energy_model *em = rcu_dereference(sched_energy);
+	unsigned long best_cost = ULONG_MAX, prev_cost = ULONG_MAX;
+	unsigned long task_load;
+	int best_cpu = -1, best_idle = 0;
+	u64 work;
+	int i;
+
+	if (!em || !em->nr_states)
+		return -1;
+
+	task_load = energy_task_load(p);
+	if (task_load > ENERGY_SMALL_TASK_LOAD) {
+		trace_sched_energy_placement(p, -1, task_load, 0, 0,
+					     ENERGY_PLACE_BIG_TASK);
+		return -1;
+	}
+
+	work = div_u64(p->se.sum_exec_runtime - p->se.prev_sum_exec_runtime,
+		       NSEC_PER_USEC) * em->cur_freq(prev_cpu);
+
+	for_each_cpu_and(i, tsk_cpus_allowed(p), cpu_online_mask) {
+		unsigned long cost = energy_run_cost(em, i, work);
+		int idle = idle_cpu(i);
+
+		if (idle) {
+			if (cpuidle_get_cpu_state(i) > 0)
+				cost += em->idle_exit_cost;
+		} else if (!energy_cpu_fits(i, task_load)) {
+			continue;
+		}
+
+		if (i == prev_cpu)
+			prev_cost = cost;
+
+		if (cost < best_cost || (cost == best_cost && i == prev_cpu)) {
+			best_cost = cost;
+			best_cpu = i;
+			best_idle = idle;
+		}
+	}
+
+	if (best_cpu < 0) {
+		trace_sched_energy_placement(p, -1, task_load, 0, prev_cost,
+					     ENERGY_PLACE_NO_CAPACITY);
+		return -1;
+	}
+
+	trace_sched_energy_placement(p, best_cpu, task_load, best_cost,
+				     prev_cost, best_idle ?
+				     ENERGY_PLACE_WAKE_IDLE : ENERGY_PLACE_PACK);
+	return best_cpu;
+}
+
+static int ui_boost_idle_cpu(struct task_struct *p, int prev_cpu)
+{
+	int i;
+
+	if (idle_cpu(prev_cpu))
+		return prev_cpu;
+
+	for_each_cpu_and(i, tsk_cpus_allowed(p), cpu_active_mask)
+		if (idle_cpu(i))
+			return i;
+
+	return -1;
+}
+
 static int
 select_task_rq_fair(struct task_struct *p, int sd_flag, int wake_flags)
 {
@@ -2229,6 +2774,20 @@ select_task_rq_fair(struct task_struct *p, int sd_flag, int wake_flags)
 	}
 
 	rcu_read_lock();
+	if ((sd_flag & SD_BALANCE_WAKE) && entity_ui_boosted(&p->se)) {
+		new_cpu = ui_boost_idle_cpu(p, prev_cpu);
+		if (new_cpu >= 0)
+			goto unlock;
+		new_cpu = prev_cpu;
+	}
+
+	if ((sd_flag & SD_BALANCE_WAKE) && sched_feat(ENERGY_AWARE)) {
+		new_cpu = energy_aware_cpu(p, prev_cpu);
+		if (new_cpu >= 0)
+			goto unlock;
+		new_cpu = prev_cpu;
+	}
+
 	for_each_domain(cpu, tmp) {
 		if (!(tmp->flags & SD_LOAD_BALANCE))
 			continue;
@@ -2402,6 +2961,12 @@ static void check_preempt_wakeup(struct rq *rq, struct task_struct *p, int wake_
 	find_matching_se(&se, &pse);
 	update_curr(cfs_rq_of(se));
 	BUG_ON(!pse);
+	if (entity_ui_boosted(pse) && !entity_ui_boosted(se)) {
+		if (!next_buddy_marked)
+			set_next_buddy(pse);
+		goto preempt;
+	}
+
 	if (wakeup_preempt_entity(se, pse) == 1) {
 		if (!next_buddy_marked)
 			set_next_buddy(pse);
@@ -2563,6 +3128,10 @@ int can_migrate_task(struct task_struct *p, struct lb_env *env)
 		schedstat_inc(p, se.statistics.nr_failed_migrations_affine);
 		return 0;
 	}
+
+	if (energy_keep_packed(p, env->src_cpu))
+		return 0;
+
 	env->flags &= ~LBF_ALL_PINNED;
 
 	if (task_running(env->src_rq, p)) {
@@ -2673,6 +3242,43 @@ next:
 	return pulled;
 }
 
+static void update_blocked_averages(int cpu)
+{
+	struct rq *rq = cpu_rq(cpu);
+	struct cfs_rq *cfs_rq;
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&rq->lock, flags);
+	update_rq_clock(rq);
+	for_each_leaf_cfs_rq(rq, cfs_rq) {
+		if (throttled_hierarchy(cfs_rq))
+			continue;
+
+		update_cfs_rq_blocked_load(cfs_rq, 1);
+#ifdef CONFIG_FAIR_GROUP_SCHED
+		if (cfs_rq->tg->se[cpu])
+			update_entity_load_avg(cfs_rq->tg->se[cpu], 1);
+#endif
+	}
+	update_rq_runnable_avg(rq, rq->nr_running);
+	raw_spin_unlock_irqrestore(&rq->lock, flags);
+}
+
+unsigned long sched_cpu_runnable_avg(int cpu)
+{
+	struct sched_avg *sa = &cpu_rq(cpu)->avg;
+
+	return div_u64((u64)sa->runnable_avg_sum << SCHED_POWER_SHIFT,
+		       sa->runnable_avg_period + 1);
+}
+EXPORT_SYMBOL_GPL(sched_cpu_runnable_avg);
+
+unsigned long sched_cpu_load_avg(int cpu)
+{
+	return cpu_rq(cpu)->cfs.runnable_load_avg;
+}
+EXPORT_SYMBOL_GPL(sched_cpu_load_avg);
+
 #ifdef CONFIG_FAIR_GROUP_SCHED
 static int update_shares_cpu(struct task_group *tg, int cpu)
 {
@@ -3583,6 +4189,7 @@ void idle_balance(int this_cpu, struct rq *this_rq)
 	raw_spin_unlock(&this_rq->lock);
 
 	update_shares(this_cpu);
+	update_blocked_averages(this_cpu);
 	rcu_read_lock();
 	for_each_domain(this_cpu, sd) {
 		unsigned long interval;
@@ -3844,6 +4451,7 @@ static void rebalance_domains(int cpu, enum cpu_idle_type idle)
 	int need_serialize;
 
 	update_shares(cpu);
+	update_blocked_averages(cpu);
 
 	rcu_read_lock();
 	for_each_domain(cpu, sd) {
@@ -3939,8 +4547,12 @@ static inline int nohz_kick_needed(struct rq *rq, int cpu)
 	if (time_before(now, nohz.next_balance))
 		return 0;
 
-	if (rq->nr_running >= 2)
+	if (rq->nr_running >= 2) {
+		if (sched_feat(ENERGY_AWARE) && rcu_access_pointer(sched_energy)
+		    && energy_cpu_fits(cpu, 0))
+			return 0;
 		goto need_kick;
+	}
 
 	rcu_read_lock();
 	for_each_domain(cpu, sd) {
@@ -4027,6 +4639,8 @@ static void task_tick_fair(struct rq *rq, struct task_struct *curr, int queued)
 		cfs_rq = cfs_rq_of(se);
 		entity_tick(cfs_rq, se, queued);
 	}
+
+	update_rq_runnable_avg(rq, 1);
 }
 
 static void task_fork_fair(struct task_struct *p)
@@ -4134,6 +4748,10 @@ void init_cfs_rq(struct cfs_rq *cfs_rq)
 #ifndef CONFIG_64BIT
 	cfs_rq->min_vruntime_copy = cfs_rq->min_vruntime;
 #endif
+#ifdef CONFIG_SMP
+	atomic64_set(&cfs_rq->decay_counter, 1);
+	atomic64_set(&cfs_rq->removed_load, 0);
+#endif
 }
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
@@ -4142,11 +4760,26 @@ static void task_move_group_fair(struct task_struct *p, int on_rq)
 	if (!on_rq && (!p->se.sum_exec_runtime || p->state == TASK_WAKING))
 		on_rq = 1;
 
-	if (!on_rq)
-		p->se.vruntime -= cfs_rq_of(&p->se)->min_vruntime;
+	if (!on_rq) {
+		struct cfs_rq *cfs_rq = cfs_rq_of(&p->se);
+
+		p->se.vruntime -= cfs_rq->min_vruntime;
+#ifdef CONFIG_SMP
+		__synchronize_entity_decay(&p->se);
+		subtract_blocked_load_contrib(cfs_rq,
+					      p->se.avg.load_avg_contrib);
+#endif
+	}
 	set_task_rq(p, task_cpu(p));
-	if (!on_rq)
-		p->se.vruntime += cfs_rq_of(&p->se)->min_vruntime;
+	if (!on_rq) {
+		struct cfs_rq *cfs_rq = cfs_rq_of(&p->se);
+
+		p->se.vruntime += cfs_rq->min_vruntime;
+#ifdef CONFIG_SMP
+		p->se.avg.decay_count = atomic64_read(&cfs_rq->decay_counter);
+		cfs_rq->blocked_load_avg += p->se.avg.load_avg_contrib;
+#endif
+	}
 }
 
 void free_fair_sched_group(struct task_group *tg)
@@ -4323,6 +4956,7 @@ const struct sched_class fair_sched_class = {
 
 #ifdef CONFIG_SMP
 	.select_task_rq		= select_task_rq_fair,
+	.migrate_task_rq	= migrate_task_rq_fair,
 
 	.rq_online		= rq_online_fair,
 	.rq_offline		= rq_offline_fair,
@@ -12,9 +12,12 @@ SCHED_FEAT(CACHE_HOT_BUDDY, true)
 
 SCHED_FEAT(ARCH_POWER, false)
 
+SCHED_FEAT(ENERGY_AWARE, false)
+
 SCHED_FEAT(HRTICK, false)
 SCHED_FEAT(DOUBLE_TICK, false)
 SCHED_FEAT(LB_BIAS, true)
+SCHED_FEAT(LB_RUNNABLE_AVG, false)
 
 SCHED_FEAT(OWNER_SPIN, true)
 
@@ -42,6 +42,22 @@ rq_sched_info_depart(struct rq *rq, unsigned long long delta)
 #endif
 
 #if defined(CONFIG_SCHEDSTATS) || defined(CONFIG_TASK_DELAY_ACCT)
+#ifdef CONFIG_FAIR_GROUP_SCHED
+static inline void
+tg_sched_info_delay(struct task_struct *t, unsigned long long delta, int arrive)
+{
+	struct cfs_rq *cfs_rq = t->se.cfs_rq;
+
+	cfs_rq->run_delay += delta;
+	if (arrive)
+		cfs_rq->run_pcount++;
+}
+#else
+static inline void
+tg_sched_info_delay(struct task_struct *t, unsigned long long delta, int arrive)
+{}
+#endif
+
 static inline void sched_info_reset_dequeued(struct task_struct *t)
 {
 	t->sched_info.last_queued = 0;
@@ -58,6 +74,7 @@ static inline void sched_info_dequeued(struct task_struct *t)
 	t->sched_info.run_delay += delta;
 
 	rq_sched_info_dequeued(task_rq(t), delta);
+	tg_sched_info_delay(t, delta, 0);
 }
 
 static void sched_info_arrive(struct task_struct *t)
@@ -72,6 +89,7 @@ static void sched_info_arrive(struct task_struct *t)
 	t->sched_info.pcount++;
 
 	rq_sched_info_arrive(task_rq(t), delta);
+	tg_sched_info_delay(t, delta, 1);
 }
 
 static inline void sched_info_queued(struct task_struct *t)
@@ -0,0 +1,188 @@
+/*
+ * kernel/time/timer_wakeups.c
+ *
+ * Count timer and hrtimer expiries per callback, and how many of them
+ * ran on a cpu that was otherwise idle, i.e. cost a wakeup.
+ *
+ * Start/stop data collection:
+ * # echo [1|0] >/sys/kernel/debug/timer_wakeups
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/hash.h>
+#include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/timer.h>
+#include <linux/uaccess.h>
+
+#define TIMER_WAKEUP_HASH_BITS	8
+#define TIMER_WAKEUP_ENTRIES	(1 << TIMER_WAKEUP_HASH_BITS)
+
+struct timer_wakeup_entry {
+	void			*fn;
+	unsigned long		count;
+	unsigned long		wakeups;
+	int			hrtimer;
+};
+
+static struct timer_wakeup_entry timer_wakeup_table[TIMER_WAKEUP_ENTRIES];
+static DEFINE_RAW_SPINLOCK(timer_wakeup_lock);
+static DEFINE_MUTEX(timer_wakeup_mutex);
+static unsigned long timer_wakeup_dropped;
+static ktime_t timer_wakeup_start, timer_wakeup_stop;
+
+int timer_wakeup_stats_active;
+
+void __timer_wakeup_account(void *fn, int hrtimer)
+{
+	struct timer_wakeup_entry *entry;
+	unsigned long flags;
+	unsigned int i, idx;
+	int idle = idle_cpu(smp_processor_id());
+
+	idx = hash_ptr(fn, TIMER_WAKEUP_HASH_BITS);
+
+	raw_spin_lock_irqsave(&timer_wakeup_lock, flags);
+	if (!timer_wakeup_stats_active)
+		goto out_unlock;
+
+	for (i = 0; i < TIMER_WAKEUP_ENTRIES; i++) {
+		entry = &timer_wakeup_table[(idx + i) % TIMER_WAKEUP_ENTRIES];
+		if (!entry->fn) {
+			entry->fn = fn;
+			entry->hrtimer = hrtimer;
+		}
+		if (entry->fn == fn) {
+			entry->count++;
+			if (idle)
+				entry->wakeups++;
+			goto out_unlock;
+		}
+	}
+	timer_wakeup_dropped++;
+
+out_unlock:
+	raw_spin_unlock_irqrestore(&timer_wakeup_lock, flags);
+}
+
+static int timer_wakeup_show(struct seq_file *m, void *v)
+{
+	struct timer_wakeup_entry *entry;
+	unsigned long count = 0, wakeups = 0;
+	ktime_t period;
+	s64 ms;
+	int i;
+
+	mutex_lock(&timer_wakeup_mutex);
+
+	period = timer_wakeup_stats_active ? ktime_get() : timer_wakeup_stop;
+	period = ktime_sub(period, timer_wakeup_start);
+	ms = ktime_to_ms(period);
+
+	seq_printf(m, "Timer wakeup stats, sample period: %lld.%03lld s\n",
+		   ms / MSEC_PER_SEC, ms % MSEC_PER_SEC);
+	if (timer_wakeup_dropped)
+		seq_printf(m, "Overflow: %lu entries\n", timer_wakeup_dropped);
+	seq_puts(m, "     count    wakeups  type  function\n");
+
+	for (i = 0; i < TIMER_WAKEUP_ENTRIES; i++) {
+		entry = &timer_wakeup_table[i];
+		if (!entry->fn)
+			continue;
+		seq_printf(m, "%10lu %10lu  %s  %pf\n", entry->count,
+			   entry->wakeups, entry->hrtimer ? "hr " : "tmr",
+			   entry->fn);
+		count += entry->count;
+		wakeups += entry->wakeups;
+	}
+
+	seq_printf(m, "%10lu %10lu  total", count, wakeups);
+	if (ms > 0) {
+		u64 rate = div64_u64((u64)wakeups * MSEC_PER_SEC * 1000, ms);
+		u32 frac;
+
+		rate = div_u64_rem(rate, 1000, &frac);
+		seq_printf(m, ", %llu.%03u idle wakeups/s",
+			   (unsigned long long)rate, frac);
+	}
+	seq_putc(m, '\n');
+
+	mutex_unlock(&timer_wakeup_mutex);
+
+	return 0;
+}
+
+static void timer_wakeup_reset(void)
+{
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&timer_wakeup_lock, flags);
+	memset(timer_wakeup_table, 0, sizeof(timer_wakeup_table));
+	timer_wakeup_dropped = 0;
+	raw_spin_unlock_irqrestore(&timer_wakeup_lock, flags);
+}
+
+static ssize_t timer_wakeup_write(struct file *file, const char __user *buf,
+				  size_t count, loff_t *offs)
+{
+	char ctl[2];
+
+	if (count != 2 || *offs)
+		return -EINVAL;
+
+	if (copy_from_user(ctl, buf, count))
+		return -EFAULT;
+
+	mutex_lock(&timer_wakeup_mutex);
+	switch (ctl[0]) {
+	case '0':
+		if (timer_wakeup_stats_active) {
+			timer_wakeup_stats_active = 0;
+			timer_wakeup_stop = ktime_get();
+		}
+		break;
+	case '1':
+		if (!timer_wakeup_stats_active) {
+			timer_wakeup_reset();
+			timer_wakeup_start = ktime_get();
+			smp_mb();
+			timer_wakeup_stats_active = 1;
+		}
+		break;
+	default:
+		count = -EINVAL;
+	}
+	mutex_unlock(&timer_wakeup_mutex);
+
+	return count;
+}
+
+static int timer_wakeup_open(struct inode *inode, struct file *filp)
+{
+	return single_open(filp, timer_wakeup_show, NULL);
+}
+
+static const struct file_operations timer_wakeup_fops = {
+	.open		= timer_wakeup_open,
+	.read		= seq_read,
+	.write		= timer_wakeup_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init init_timer_wakeup_debugfs(void)
+{
+	debugfs_create_file("timer_wakeups", 0644, NULL, NULL,
+			    &timer_wakeup_fops);
+	return 0;
+}
+__initcall(init_timer_wakeup_debugfs);
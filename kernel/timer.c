@@ -40,6 +40,8 @@
 #include <linux/irq_work.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
+#include <linux/moduleparam.h>
+#include <linux/log2.h>
 
 #include <asm/uaccess.h>
 #include <asm/unistd.h>
@@ -108,6 +110,27 @@ timer_set_base(struct timer_list *timer, struct tvec_base *new_base)
 				      tbase_get_deferrable(timer->base));
 }
 
+/*
+ * Deferrable timers may run late anyway, so their expiry is rounded up to
+ * a multiple of deferrable_align jiffies (a power of two, 1 disables it).
+ * Timers on all cpus then share expiry points and get batched into the
+ * same wakeups.
+ */
+static unsigned int deferrable_align = 1;
+module_param(deferrable_align, uint, 0644);
+
+static inline unsigned long
+deferrable_align_expires(struct timer_list *timer, unsigned long expires)
+{
+	unsigned long align = ACCESS_ONCE(deferrable_align);
+
+	if (!tbase_get_deferrable(timer->base) || align <= 1 ||
+	    !is_power_of_2(align))
+		return expires;
+
+	return ALIGN(expires, align);
+}
+
 static unsigned long round_jiffies_common(unsigned long j, int cpu,
 		bool force_up)
 {
@@ -574,6 +597,9 @@ unsigned long apply_slack(struct timer_list *timer, unsigned long expires)
 
 	if (timer->slack >= 0) {
 		expires_limit = expires + timer->slack;
+	} else if (tbase_get_deferrable(timer->base) &&
+		   ACCESS_ONCE(deferrable_align) > 1) {
+		return deferrable_align_expires(timer, expires);
 	} else {
 		long delta = expires - jiffies;
 
@@ -608,6 +634,8 @@ EXPORT_SYMBOL(mod_timer);
 
 int mod_timer_pinned(struct timer_list *timer, unsigned long expires)
 {
+	expires = deferrable_align_expires(timer, expires);
+
 	if (timer->expires == expires && timer_pending(timer))
 		return 1;
 
@@ -629,6 +657,7 @@ void add_timer_on(struct timer_list *timer, int cpu)
 
 	timer_stats_timer_set_start_info(timer);
 	BUG_ON(timer_pending(timer) || !timer->function);
+	timer->expires = deferrable_align_expires(timer, timer->expires);
 	spin_lock_irqsave(&base->lock, flags);
 	timer_set_base(timer, base);
 	debug_activate(timer, timer->expires);
@@ -784,6 +813,7 @@ static inline void __run_timers(struct tvec_base *base)
 			data = timer->data;
 
 			timer_stats_account_timer(timer);
+			timer_wakeup_account(fn, 0);
 
 			base->running_timer = timer;
 			detach_timer(timer, 1);
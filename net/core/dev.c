@@ -76,6 +76,7 @@
 #include <linux/bitops.h>
 #include <linux/capability.h>
 #include <linux/cpu.h>
+#include <linux/cpuidle.h>
 #include <linux/types.h>
 #include <linux/kernel.h>
 #include <linux/hash.h>
@@ -2062,6 +2063,61 @@ EXPORT_SYMBOL(rps_sock_flow_table);
 
 struct static_key rps_needed __read_mostly;
 
+int rps_online_steering __read_mostly;
+
+static struct cpumask rps_steer_cpus;
+
+static inline bool rps_cpu_usable(int cpu)
+{
+	if (!rps_online_steering)
+		return cpu_online(cpu);
+
+	return cpumask_test_cpu(cpu, &rps_steer_cpus) &&
+	       cpuidle_get_cpu_state(cpu) <= 0;
+}
+
+static int rps_select_usable_cpu(const struct rps_map *map, u32 hash)
+{
+	unsigned int i, n = 0;
+	int cpu = -1;
+
+	for (i = 0; i < map->len; i++)
+		if (rps_cpu_usable(map->cpus[i]))
+			n++;
+
+	if (n) {
+		n = ((u64) hash * n) >> 32;
+		for (i = 0; i < map->len; i++) {
+			if (!rps_cpu_usable(map->cpus[i]))
+				continue;
+			cpu = map->cpus[i];
+			if (!n--)
+				break;
+		}
+	}
+
+	if (cpu < 0)
+		__this_cpu_inc(softnet_data.steer_fallback);
+	return cpu;
+}
+
+static int rps_cpu_callback(struct notifier_block *nfb,
+			    unsigned long action, void *hcpu)
+{
+	unsigned int cpu = (unsigned long)hcpu;
+
+	switch (action & ~CPU_TASKS_FROZEN) {
+	case CPU_ONLINE:
+	case CPU_DOWN_FAILED:
+		cpumask_set_cpu(cpu, &rps_steer_cpus);
+		break;
+	case CPU_DOWN_PREPARE:
+		cpumask_clear_cpu(cpu, &rps_steer_cpus);
+		break;
+	}
+	return NOTIFY_OK;
+}
+
 static struct rps_dev_flow *
 set_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 	    struct rps_dev_flow *rflow, u16 next_cpu)
@@ -2135,8 +2191,10 @@ static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 		if (map->len == 1 &&
 		    !rcu_access_pointer(rxqueue->rps_flow_table)) {
 			tcpu = map->cpus[0];
-			if (cpu_online(tcpu))
+			if (rps_cpu_usable(tcpu))
 				cpu = tcpu;
+			else if (rps_online_steering)
+				__this_cpu_inc(softnet_data.steer_fallback);
 			goto done;
 		}
 	} else if (!rcu_access_pointer(rxqueue->rps_flow_table)) {
@@ -2177,10 +2235,13 @@ static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 	if (map) {
 		tcpu = map->cpus[((u64) skb->rxhash * map->len) >> 32];
 
-		if (cpu_online(tcpu)) {
+		if (rps_cpu_usable(tcpu)) {
 			cpu = tcpu;
 			goto done;
 		}
+
+		if (rps_online_steering)
+			cpu = rps_select_usable_cpu(map, skb->rxhash);
 	}
 
 done:
@@ -2254,6 +2315,8 @@ static int enqueue_to_backlog(struct sk_buff *skb, int cpu,
 
 	rps_lock(sd);
 	if (skb_queue_len(&sd->input_pkt_queue) <= netdev_max_backlog) {
+		if (cpu != smp_processor_id())
+			sd->steered_rps++;
 		if (skb_queue_len(&sd->input_pkt_queue)) {
 enqueue:
 			__skb_queue_tail(&sd->input_pkt_queue, skb);
@@ -3401,6 +3464,14 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 	return 0;
 }
 
+static int softnet_steer_seq_show(struct seq_file *seq, void *v)
+{
+	struct softnet_data *sd = v;
+
+	seq_printf(seq, "%08x %08x\n", sd->steered_rps, sd->steer_fallback);
+	return 0;
+}
+
 static const struct seq_operations dev_seq_ops = {
 	.start = dev_seq_start,
 	.next  = dev_seq_next,
@@ -3442,6 +3513,26 @@ static const struct file_operations softnet_seq_fops = {
 	.release = seq_release,
 };
 
+static const struct seq_operations softnet_steer_seq_ops = {
+	.start = softnet_seq_start,
+	.next  = softnet_seq_next,
+	.stop  = softnet_seq_stop,
+	.show  = softnet_steer_seq_show,
+};
+
+static int softnet_steer_seq_open(struct inode *inode, struct file *file)
+{
+	return seq_open(file, &softnet_steer_seq_ops);
+}
+
+static const struct file_operations softnet_steer_seq_fops = {
+	.owner	 = THIS_MODULE,
+	.open    = softnet_steer_seq_open,
+	.read    = seq_read,
+	.llseek  = seq_lseek,
+	.release = seq_release,
+};
+
 static void *ptype_get_idx(loff_t pos)
 {
 	struct packet_type *pt = NULL;
@@ -3555,8 +3646,11 @@ static int __net_init dev_proc_net_init(struct net *net)
 		goto out;
 	if (!proc_net_fops_create(net, "softnet_stat", S_IRUGO, &softnet_seq_fops))
 		goto out_dev;
-	if (!proc_net_fops_create(net, "ptype", S_IRUGO, &ptype_seq_fops))
+	if (!proc_net_fops_create(net, "softnet_steer", S_IRUGO,
+				  &softnet_steer_seq_fops))
 		goto out_softnet;
+	if (!proc_net_fops_create(net, "ptype", S_IRUGO, &ptype_seq_fops))
+		goto out_steer;
 
 	if (wext_proc_init(net))
 		goto out_ptype;
@@ -3565,6 +3659,8 @@ out:
 	return rc;
 out_ptype:
 	proc_net_remove(net, "ptype");
+out_steer:
+	proc_net_remove(net, "softnet_steer");
 out_softnet:
 	proc_net_remove(net, "softnet_stat");
 out_dev:
@@ -3577,6 +3673,7 @@ static void __net_exit dev_proc_net_exit(struct net *net)
 	wext_proc_exit(net);
 
 	proc_net_remove(net, "ptype");
+	proc_net_remove(net, "softnet_steer");
 	proc_net_remove(net, "softnet_stat");
 	proc_net_remove(net, "dev");
 }
@@ -5318,6 +5415,10 @@ static int __init net_dev_init(void)
 	open_softirq(NET_RX_SOFTIRQ, net_rx_action);
 
 	hotcpu_notifier(dev_cpu_callback, 0);
+#ifdef CONFIG_RPS
+	cpumask_copy(&rps_steer_cpus, cpu_online_mask);
+	hotcpu_notifier(rps_cpu_callback, 0);
+#endif
 	dst_init();
 	dev_mcast_init();
 	rc = 0;
@@ -0,0 +1,212 @@
+#include <linux/err.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/jhash.h>
+#include <linux/random.h>
+#include <linux/seqlock.h>
+#include <linux/slab.h>
+#include <linux/crypto.h>
+#include <net/inet_sock.h>
+#include <net/ipv6.h>
+#include <net/tcp.h>
+
+int sysctl_tcp_fastopen __read_mostly = TFO_CLIENT_ENABLE;
+
+struct tcp_fastopen_context __rcu *tcp_fastopen_ctx;
+
+static DEFINE_SPINLOCK(tcp_fastopen_ctx_lock);
+
+static void tcp_fastopen_ctx_free(struct rcu_head *head)
+{
+	struct tcp_fastopen_context *ctx =
+	    container_of(head, struct tcp_fastopen_context, rcu);
+	crypto_free_cipher(ctx->tfm);
+	kfree(ctx);
+}
+
+int tcp_fastopen_reset_cipher(void *key, unsigned int len)
+{
+	int err;
+	struct tcp_fastopen_context *ctx, *octx;
+
+	ctx = kmalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+	ctx->tfm = crypto_alloc_cipher("aes", 0, 0);
+
+	if (IS_ERR(ctx->tfm)) {
+		err = PTR_ERR(ctx->tfm);
+error:		kfree(ctx);
+		pr_err("TCP: TFO aes cipher alloc error: %d\n", err);
+		return err;
+	}
+	err = crypto_cipher_setkey(ctx->tfm, key, len);
+	if (err) {
+		pr_err("TCP: TFO cipher key error: %d\n", err);
+		crypto_free_cipher(ctx->tfm);
+		goto error;
+	}
+	memcpy(ctx->key, key, len);
+
+	spin_lock(&tcp_fastopen_ctx_lock);
+
+	octx = rcu_dereference_protected(tcp_fastopen_ctx,
+				lockdep_is_held(&tcp_fastopen_ctx_lock));
+	rcu_assign_pointer(tcp_fastopen_ctx, ctx);
+	spin_unlock(&tcp_fastopen_ctx_lock);
+
+	if (octx)
+		call_rcu(&octx->rcu, tcp_fastopen_ctx_free);
+	return err;
+}
+
+/*
+ * The cookie is the AES encryption of the peer address (zero padded to
+ * 128 bits) under the current server key. The caller checks foc->len to
+ * find out whether a cookie was generated.
+ */
+void tcp_fastopen_cookie_gen(__be32 addr, struct tcp_fastopen_cookie *foc)
+{
+	__be32 peer_addr[4] = { addr, 0, 0, 0 };
+	struct tcp_fastopen_context *ctx;
+
+	rcu_read_lock();
+	ctx = rcu_dereference(tcp_fastopen_ctx);
+	if (ctx) {
+		crypto_cipher_encrypt_one(ctx->tfm,
+					  foc->val,
+					  (__u8 *)peer_addr);
+		foc->len = TCP_FASTOPEN_COOKIE_SIZE;
+	}
+	rcu_read_unlock();
+}
+
+int tcp_fastopen_init_queue(struct sock *sk, int backlog)
+{
+	struct request_sock_queue *queue =
+	    &inet_csk(sk)->icsk_accept_queue;
+
+	if (queue->fastopenq == NULL) {
+		queue->fastopenq = kzalloc(sizeof(struct fastopen_queue),
+					   sk->sk_allocation);
+		if (queue->fastopenq == NULL)
+			return -ENOMEM;
+
+		sk->sk_destruct = tcp_sock_destruct;
+		spin_lock_init(&queue->fastopenq->lock);
+	}
+	queue->fastopenq->max_qlen = backlog;
+	return 0;
+}
+
+/*
+ * Client side cookie cache. There is no per-destination metrics store in
+ * this tree, so cookies live in a small direct-mapped table keyed by the
+ * peer address; a colliding destination simply evicts the older entry and
+ * costs one extra cookie request round trip.
+ */
+#define TCP_FASTOPEN_CACHE_BITS	8
+#define TCP_FASTOPEN_CACHE_SIZE	(1 << TCP_FASTOPEN_CACHE_BITS)
+
+struct tcp_fastopen_addr {
+	unsigned short		family;
+	__be32			addr[4];
+};
+
+struct tcp_fastopen_cache_entry {
+	struct tcp_fastopen_addr	addr;
+	u16				mss;
+	u16				syn_loss;
+	unsigned long			last_syn_loss;
+	struct tcp_fastopen_cookie	cookie;
+};
+
+static struct tcp_fastopen_cache_entry tcp_fastopen_cache[TCP_FASTOPEN_CACHE_SIZE];
+static DEFINE_SEQLOCK(tcp_fastopen_cache_lock);
+static u32 tcp_fastopen_cache_rnd __read_mostly;
+
+static void tcp_fastopen_addr_get(const struct sock *sk,
+				  struct tcp_fastopen_addr *a)
+{
+	memset(a, 0, sizeof(*a));
+	a->family = sk->sk_family;
+#if IS_ENABLED(CONFIG_IPV6)
+	if (sk->sk_family == AF_INET6) {
+		memcpy(a->addr, &inet6_sk(sk)->daddr, sizeof(a->addr));
+		return;
+	}
+#endif
+	a->addr[0] = inet_sk(sk)->inet_daddr;
+}
+
+static struct tcp_fastopen_cache_entry *
+tcp_fastopen_cache_slot(const struct tcp_fastopen_addr *a)
+{
+	u32 hash = jhash2((const u32 *)a->addr, 4,
+			  tcp_fastopen_cache_rnd ^ a->family);
+
+	return &tcp_fastopen_cache[hash & (TCP_FASTOPEN_CACHE_SIZE - 1)];
+}
+
+void tcp_fastopen_cache_get(struct sock *sk, u16 *mss,
+			    struct tcp_fastopen_cookie *cookie,
+			    int *syn_loss, unsigned long *last_syn_loss)
+{
+	struct tcp_fastopen_cache_entry *e;
+	struct tcp_fastopen_addr a;
+	unsigned int seq;
+
+	tcp_fastopen_addr_get(sk, &a);
+	e = tcp_fastopen_cache_slot(&a);
+
+	do {
+		seq = read_seqbegin(&tcp_fastopen_cache_lock);
+		if (memcmp(&e->addr, &a, sizeof(a)))
+			continue;
+		if (e->mss)
+			*mss = e->mss;
+		*cookie = e->cookie;
+		*syn_loss = e->syn_loss;
+		*last_syn_loss = *syn_loss ? e->last_syn_loss : 0;
+	} while (read_seqretry(&tcp_fastopen_cache_lock, seq));
+}
+
+void tcp_fastopen_cache_set(struct sock *sk, u16 mss,
+			    struct tcp_fastopen_cookie *cookie,
+			    bool syn_lost)
+{
+	struct tcp_fastopen_cache_entry *e;
+	struct tcp_fastopen_addr a;
+
+	tcp_fastopen_addr_get(sk, &a);
+	e = tcp_fastopen_cache_slot(&a);
+
+	write_seqlock_bh(&tcp_fastopen_cache_lock);
+	if (memcmp(&e->addr, &a, sizeof(a))) {
+		memset(e, 0, sizeof(*e));
+		e->addr = a;
+	}
+	if (mss)
+		e->mss = mss;
+	if (cookie && cookie->len > 0)
+		e->cookie = *cookie;
+	if (syn_lost) {
+		++e->syn_loss;
+		e->last_syn_loss = jiffies;
+	} else
+		e->syn_loss = 0;
+	write_sequnlock_bh(&tcp_fastopen_cache_lock);
+}
+
+static int __init tcp_fastopen_init(void)
+{
+	__u8 key[TCP_FASTOPEN_KEY_LENGTH];
+
+	get_random_bytes(&tcp_fastopen_cache_rnd,
+			 sizeof(tcp_fastopen_cache_rnd));
+	get_random_bytes(key, sizeof(key));
+	tcp_fastopen_reset_cipher(key, sizeof(key));
+	return 0;
+}
+
+late_initcall(tcp_fastopen_init);